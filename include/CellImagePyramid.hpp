@@ -0,0 +1,52 @@
+#pragma once
+
+#include <QImage>
+#include <QSize>
+#include <cstdint>
+#include <vector>
+
+namespace app::ui
+{
+    // Piramida mipmap obrazu komórek. Poziom 0 to sam obraz bazowy (nie jest kopiowany),
+    // poziom k ma rozmiar ceil(rozmiar / 2^k). Każdy piksel poziomu k to średnia
+    // (premultiplied ARGB) 2x2 pikseli poziomu k-1, czyli mieszanka A/B/neutralnych.
+    // Przebudowywane są tylko kafelki oznaczone jako zmienione.
+    class CellImagePyramid
+    {
+        public:
+            static constexpr int kTileShift = 5; // kafelek 32x32 px
+            static constexpr int kTileSize  = 1 << kTileShift;
+            static constexpr int kMaxLevels = 8;
+
+            void reset(const QSize& baseSize);
+
+            void markDirty(int x, int y)
+            {
+                Level& base = m_levels.front();
+                base.dirty[static_cast<std::size_t>(y >> kTileShift) *
+                               static_cast<std::size_t>(base.tilesX) +
+                           static_cast<std::size_t>(x >> kTileShift)] = 1;
+                m_hasDirty = true;
+            }
+
+            void update(const QImage& base);
+
+            [[nodiscard]] int           levelCount() const;
+            [[nodiscard]] const QImage& levelImage(int level, const QImage& base) const;
+            [[nodiscard]] int           levelForScale(qreal devicePixelsPerCell) const;
+
+        private:
+            struct Level
+            {
+                    QImage               image;
+                    int                  tilesX = 0;
+                    int                  tilesY = 0;
+                    std::vector<uint8_t> dirty;
+            };
+
+            std::vector<Level> m_levels;
+            bool               m_hasDirty = false;
+
+            static void downsampleRegion(const QImage& src, QImage& dst, const QRect& dstRect);
+    };
+} // namespace app::ui
@@ -2,6 +2,7 @@
 #include <QColor>
 #include <QStringLiteral>
 #include <QVector3D>
+#include <cstddef>
 #include <qvectornd.h>
 
 namespace Config
@@ -11,9 +12,19 @@ namespace Config
         inline constexpr int pixelWidth  = 1260;
         inline constexpr int pixelHeight = 790;
 
-        extern int cellSize;
-        extern int gridCols;
-        extern int gridRows;
+        // Rozdzielczości do wyboru w trakcie działania: bok komórki w pikselach widoku.
+        // Grube siatki do szybkiego rozpoznania, najdrobniejsza do właściwych przebiegów.
+        inline constexpr int cellSizes[]     = {1, 2, 3, 5, 10};
+        inline constexpr int defaultCellSize = 1;
+
+        constexpr int colsFor(int cellSize)
+        {
+            return pixelWidth / cellSize;
+        }
+        constexpr int rowsFor(int cellSize)
+        {
+            return pixelHeight / cellSize;
+        }
     } // namespace Grid
 
     namespace Window
@@ -52,8 +63,16 @@ namespace Config
         inline const QString simulationSpeed   = QStringLiteral("Simulation speed:");
         inline const QString slower            = QStringLiteral("-");
         inline const QString faster            = QStringLiteral("+");
+        inline const QString turbo             = QStringLiteral("Turbo");
+        inline const QString stepsPerFrame     = QStringLiteral("Steps/frame:");
+        inline const QString autoSteps         = QStringLiteral("Auto");
         inline const QString scenarioPreset    = QStringLiteral("Scenario preset:");
-        inline const QString scenario1         = QStringLiteral("Scenario 1");
+        inline const QString seedUniform       = QStringLiteral("Uniform random");
+        inline const QString seedClustered     = QStringLiteral("Clustered");
+        inline const QString seedStateQuota    = QStringLiteral("Equal per state");
+        inline const QString seedGradient      = QStringLiteral("West-east gradient");
+        inline const QString resolution        = QStringLiteral("Resolution:");
+        inline const QString resolutionItem    = QStringLiteral("%1 x %2");
         inline const QString modelParameters   = QStringLiteral("Model parameters");
         inline const QString playerSettings    = QStringLiteral("Player Settings");
         inline const QString playerA           = QStringLiteral("Player A");
@@ -64,7 +83,39 @@ namespace Config
         inline const QString cost              = QStringLiteral("Cost: ");
         inline const QString useMap            = QStringLiteral("Use map");
         inline const QString paintMode         = QStringLiteral("Paint mode");
+        inline const QString toolBrush         = QStringLiteral("Brush");
+        inline const QString toolRectangle     = QStringLiteral("Rectangle");
+        inline const QString toolPolygon       = QStringLiteral("Polygon");
+        inline const QString toolStateFill     = QStringLiteral("Fill state");
+        inline const QString toolStateSeed     = QStringLiteral("Seed state");
+        inline const QString brushRadius       = QStringLiteral("Radius:");
+        inline const QString seedPercent       = QStringLiteral("Seed %:");
         inline const QString physics           = QStringLiteral("Physics");
+        inline const QString overlay           = QStringLiteral("Overlay:");
+        inline const QString overlaySide       = QStringLiteral("Side");
+        inline const QString overlayHysteresis = QStringLiteral("Hysteresis");
+        inline const QString overlayThreshold  = QStringLiteral("Threshold");
+        inline const QString overlayField      = QStringLiteral("Field h");
+        inline const QString overlayFlipAge    = QStringLiteral("Time since flip");
+        inline const QString chartWindow       = QStringLiteral("Window:");
+        inline const QString chartWindowLast   = QStringLiteral("Last %1");
+        inline const QString chartWindowAll    = QStringLiteral("All");
+        inline const QString recordStats       = QStringLiteral("Record...");
+        inline const QString stopRecording     = QStringLiteral("Stop recording");
+        inline const QString recordFilterCsv   = QStringLiteral("CSV (*.csv)");
+        inline const QString recordFilterBin   = QStringLiteral("Binary columnar (*.pstats)");
+        inline const QString saveCheckpoint    = QStringLiteral("Save state...");
+        inline const QString loadCheckpoint    = QStringLiteral("Load state...");
+        inline const QString checkpointFilter  = QStringLiteral("Checkpoint (*.pckpt)");
+        inline const QString recordTrajectory  = QStringLiteral("Record trajectory...");
+        inline const QString stopTrajectory    = QStringLiteral("Stop trajectory");
+        inline const QString trajectoryFilter  = QStringLiteral("Trajectory (*.ptraj)");
+        inline const QString openReplay        = QStringLiteral("Open replay...");
+        inline const QString closeReplay       = QStringLiteral("Close replay");
+        inline const QString replayIdle        = QStringLiteral("Replay: -");
+        inline const QString replayPosition    = QStringLiteral("Replay: %1 / %2");
+        inline const QString targetStates      = QStringLiteral("Target states");
+        inline const QString allStates         = QStringLiteral("All states");
     } // namespace UiText
 
     namespace UiValues
@@ -86,11 +137,57 @@ namespace Config
     namespace Timing
     {
         inline constexpr int simulationSpeed = 50;
+        inline constexpr int slowIntervalMs  = 1000;
+        inline constexpr int fastIntervalMs  = 16;
+
+        // Turbo: kroki nie są związane z timerem, tylko z budżetem klatki
+        inline constexpr int    frameIntervalMs       = 16;
+        inline constexpr double turboFrameBudgetMs    = 12.0; // reszta klatki zostaje na repaint
+        inline constexpr int    turboMaxStepsPerFrame = 1000;
+        inline constexpr double stepTimeSmoothing     = 0.2; // EMA zmierzonego czasu kroku
     } // namespace Timing
 
+    namespace Stats
+    {
+        // Wykresy odświeżamy z tą częstotliwością, niezależnie od tempa kroków
+        inline constexpr int refreshIntervalMs = 100;
+        inline constexpr int maxChartPoints    = 1200;
+
+        // Okna wykresów w iteracjach; 0 = cała historia
+        inline constexpr int chartWindows[] = {maxChartPoints, 10000, 100000, 0};
+
+        inline constexpr std::size_t historyLevelCapacity = 16384; // punktów na poziom LTTB
+
+        // Zapis w tle: paczka wierszy albo limit czasu, co nastąpi pierwsze
+        inline constexpr std::size_t exportBatchRows       = 512;
+        inline constexpr int         exportFlushIntervalMs = 500;
+    } // namespace Stats
+
+    namespace Trajectory
+    {
+        // Co tyle kroków pełny keyframe; koszt przewijania to najwyżej tyle delt
+        inline constexpr int keyframeInterval = 256;
+        inline constexpr int compressionLevel = 1; // zlib: szybko, delty i tak są małe
+    } // namespace Trajectory
+
     namespace Map
     {
         inline const QString usSvgPath = QStringLiteral("Propaganda-spread-model/map/us_test.svg");
+
+        // Powyżej tego rozmiaru (w pikselach urządzenia) kontury całej mapy nie mieszczą się
+        // w jednej pixmapie - cache'ujemy wtedy kafle widocznego fragmentu (bok w pikselach
+        // logicznych), a łączny rozmiar kafli w cache ma ten sam limit
+        inline constexpr qint64 outlineCacheMaxPixels = 4096LL * 4096LL;
+        inline constexpr int    outlineTileSize       = 512;
+
+        // Rasteryzacja kaflami: bok kafla w komórkach i subpiksele na bok komórki
+        inline constexpr int rasterTileCells   = 256;
+        inline constexpr int rasterSupersample = 3;
+        inline constexpr int maxSamples        = 16; // rasterSupersample^2 nie może przekroczyć
+        static_assert(rasterSupersample * rasterSupersample <= maxSamples);
+
+        // Podkatalog QStandardPaths::CacheLocation na zrasteryzowane produkty mapy
+        inline const QString productsCacheDir = QStringLiteral("usmap");
     } // namespace Map
 
     namespace Simulation
@@ -98,6 +195,23 @@ namespace Config
         constexpr float kEffWhite = 1.0f;
         constexpr float kEffGray  = 1.2f;
         constexpr float kEffBlack = 1.5f;
+
+        // Krok dzielony na wątki po wierszach; mniejsze siatki liczy jeden wątek
+        constexpr std::size_t minCellsPerWorker = 1 << 15;
+
+        // Kampania w wybranych stanach: sygnał na komórkę rośnie najwyżej tyle razy
+        // względem kampanii ogólnokrajowej (nasycenie przy bardzo małych celach)
+        constexpr float maxTargetGain = 10.0f;
+
+        // Warunki początkowe po reset(): liczba zwolenników stron i plam w wariancie skupionym
+        constexpr int initialSeedsA = 2500;
+        constexpr int initialSeedsB = 2500;
+        constexpr int seedClusters  = 12;
+
+        // Losowanie dzielone na bloki ok. tylu komórek, każdy z własnym generatorem
+        // (wynik nie zależy od liczby wątków); gradient liczy limity w pasach kolumn
+        constexpr std::size_t seedBlockCells    = 1 << 16;
+        constexpr std::size_t seedGradientBands = 64;
     } // namespace Simulation
 
     namespace Neighbourhood
@@ -123,5 +237,14 @@ namespace Config
 
         inline constexpr int frameThickness = 1;
 
+        // Malowanie: promień pędzla w komórkach i domyślny odsetek komórek stanu do zasiania
+        inline constexpr int maxBrushRadius     = 50;
+        inline constexpr int defaultSeedPercent = 10;
+
+        // Zakresy normalizacji nakładek (wartość -> indeks w LUT)
+        inline constexpr double overlayThresholdMax = 1.0;
+        inline constexpr double overlayFieldRange   = 2.0; // h w [-range, range]
+        inline constexpr int    overlayFlipAgeMax   = 200; // iteracje
+
     } // namespace GridWidget
 } // namespace Config
@@ -0,0 +1,155 @@
+#pragma once
+
+#include "Types.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+// Ciągły odcinek aktywnych komórek wiersza, kolumny [begin, end); komórka (x, y)
+// z odcinka ma w tablicach stanu indeks gęsty offset + (x - begin)
+struct CellSpan
+{
+        int      begin  = 0;
+        int      end    = 0;
+        uint32_t offset = 0;
+};
+
+// Odcinki w układzie CSR (odcinki wiersza y to spans[rowStart[y] .. rowStart[y + 1])),
+// wspólne dla GridView i wewnętrznych pętli Simulation
+namespace CellSpans
+{
+    inline std::span<const CellSpan>
+    row(std::span<const CellSpan> spans, std::span<const std::size_t> rowStart, int y)
+    {
+        const auto r = static_cast<std::size_t>(y);
+        return spans.subspan(rowStart[r], rowStart[r + 1] - rowStart[r]);
+    }
+
+    // Indeks gęsty kolumny x w odcinkach jednego wiersza albo -1 poza maską; odcinków
+    // w wierszu jest kilka, więc wystarczy przejść je po kolei
+    inline std::ptrdiff_t denseIndex(std::span<const CellSpan> rowSpans, int x)
+    {
+        for (const CellSpan& span : rowSpans)
+        {
+            if (x < span.begin)
+            {
+                break;
+            }
+            if (x < span.end)
+            {
+                return static_cast<std::ptrdiff_t>(span.offset) + (x - span.begin);
+            }
+        }
+        return -1;
+    }
+} // namespace CellSpans
+
+// Jedno pole komórek (np. side, threshold) czytane wprost z tablicy CellData, co
+// sizeof(CellData) bajtów; nic nie jest kopiowane
+template <typename T> class StridedPlane
+{
+    public:
+        StridedPlane() = default;
+        StridedPlane(const T* first, std::size_t stride, std::size_t size)
+            : m_first{reinterpret_cast<const std::byte*>(first)}, m_stride{stride}, m_size{size}
+        {
+        }
+
+        [[nodiscard]] std::size_t size() const { return m_size; }
+        [[nodiscard]] bool        empty() const { return m_size == 0; }
+
+        [[nodiscard]] const T& operator[](std::size_t i) const
+        {
+            return *reinterpret_cast<const T*>(m_first + i * m_stride);
+        }
+
+    private:
+        const std::byte* m_first  = nullptr;
+        std::size_t      m_stride = 0;
+        std::size_t      m_size   = 0;
+};
+
+// Widok tylko do odczytu na stan symulacji (Simulation::view()), bez kopiowania.
+// Stan jest indeksowany gęsto po odcinkach aktywnych komórek wiersza, więc odczyt wiersza
+// to kilka ciągłych przebiegów po tablicach. Widok jest ważny do zmiany rozmiaru albo
+// maski (reset, resize, loadCheckpoint); version() zmienia się przy każdej zmianie stanu
+// (krok, malowanie, reset...), więc zapamiętana wersja wystarcza do wykrycia nieaktualności.
+class GridView
+{
+    public:
+        [[nodiscard]] int         cols() const { return m_cols; }
+        [[nodiscard]] int         rows() const { return m_rows; }
+        [[nodiscard]] std::size_t cellCount() const { return m_cells.size(); }
+        [[nodiscard]] uint64_t    version() const { return m_version; }
+
+        [[nodiscard]] std::span<const CellSpan> rowSpans(int y) const
+        {
+            return CellSpans::row(m_spans, m_rowSpanStart, y);
+        }
+
+        // Indeks gęsty komórki (x, y) albo -1 poza siatką i maską
+        [[nodiscard]] std::ptrdiff_t denseIndex(int x, int y) const
+        {
+            if (x < 0 or y < 0 or x >= m_cols or y >= m_rows)
+            {
+                return -1;
+            }
+            return CellSpans::denseIndex(rowSpans(y), x);
+        }
+
+        // Odcinki aktywnych komórek wiersza y przycięte do kolumn [x0, x1]:
+        // fn(pierwsza kolumna, indeks gęsty, liczba komórek)
+        template <typename Fn> void forEachRun(int y, int x0, int x1, Fn&& fn) const
+        {
+            for (const CellSpan& span : rowSpans(y))
+            {
+                const int begin = std::max(span.begin, x0);
+                const int end   = std::min(span.end, x1 + 1);
+                if (begin < end)
+                {
+                    fn(begin, span.offset + static_cast<std::size_t>(begin - span.begin),
+                       static_cast<std::size_t>(end - begin));
+                }
+            }
+        }
+
+        // Płaszczyzny indeksowane gęsto; pole i iteracje zmian są puste, gdy ich nie zbieramy
+        [[nodiscard]] std::span<const CellData> cells() const { return m_cells; }
+        [[nodiscard]] std::span<const float>    field() const { return m_field; }
+        [[nodiscard]] std::span<const int>      lastFlipIterations() const { return m_lastFlip; }
+
+        [[nodiscard]] StridedPlane<Side>    sides() const { return plane(&CellData::side); }
+        [[nodiscard]] StridedPlane<uint8_t> stateIds() const { return plane(&CellData::stateId); }
+        [[nodiscard]] StridedPlane<double>  thresholds() const
+        {
+            return plane(&CellData::threshold);
+        }
+        [[nodiscard]] StridedPlane<double> hystereses() const
+        {
+            return plane(&CellData::hysteresis);
+        }
+
+    private:
+        friend class Simulation;
+
+        template <typename T> [[nodiscard]] StridedPlane<T> plane(T CellData::* member) const
+        {
+            if (m_cells.empty())
+            {
+                return {};
+            }
+            return {&(m_cells.front().*member), sizeof(CellData), m_cells.size()};
+        }
+
+        int      m_cols    = 0;
+        int      m_rows    = 0;
+        uint64_t m_version = 0;
+
+        std::span<const CellSpan>    m_spans;
+        std::span<const std::size_t> m_rowSpanStart;
+        std::span<const CellData>    m_cells;
+        std::span<const float>       m_field;
+        std::span<const int>         m_lastFlip;
+};
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "CellImagePyramid.hpp"
 #include "Simulation.hpp"
 #include "Types.hpp"
 #include "UsMap.hpp"
@@ -9,8 +10,10 @@
 #include <QMouseEvent>
 #include <QPainter>
 #include <QPoint>
+#include <QPolygon>
 #include <QWidget>
 #include <cstdint>
+#include <vector>
 
 namespace app::ui
 {
@@ -25,14 +28,24 @@ namespace app::ui
             void setShowGrid(bool) noexcept;
             void setMapMode(bool) noexcept;
             void setPaintMode(bool) noexcept;
+            void setPaintTool(PaintTool) noexcept;
+            void setOverlayMode(OverlayMode) noexcept;
+            // Strony komórek z odtwarzanego nagrania zamiast z symulacji; nullptr = na żywo
+            void setSideOverride(const std::vector<uint8_t>* sides) noexcept;
             void clearMap() noexcept;
             void resetView() noexcept;
+            // Odświeża tylko fragment widoku z podanymi komórkami (np. po malowaniu);
+            // pozostałe komórki nie są ponownie rasteryzowane
+            void invalidateCells(const QRect& cells);
 
             [[nodiscard]] QColor getColorFor(CellData) const noexcept;
 
         signals:
             void cellRemoved(int x, int y);
-            void paintCellRequested(int x, int y, Side side);
+            void paintBrushRequested(QPoint from, QPoint to, Side side); // odcinek przeciągnięcia
+            void paintRectRequested(const QRect& cells, Side side);
+            void paintPolygonRequested(const QPolygon& vertices, Side side);
+            void paintStateRequested(uint8_t stateId, Side side);
             void zoomChanged(double zoomFactor);
             void cellInfoChanged(const QString& info);
 
@@ -41,6 +54,7 @@ namespace app::ui
             void mousePressEvent(QMouseEvent*) override;
             void mouseMoveEvent(QMouseEvent* event) override;
             void mouseReleaseEvent(QMouseEvent* event) override;
+            void mouseDoubleClickEvent(QMouseEvent* event) override;
             void leaveEvent(QEvent* event) override;
             void wheelEvent(QWheelEvent* event) override;
 
@@ -56,12 +70,28 @@ namespace app::ui
             bool    m_paintMode{false};
             QPoint  m_lastPanPos;
 
+            // Malowanie: ostatnia komórka pędzla i kształt w trakcie rysowania
+            PaintTool m_paintTool{PaintTool::BRUSH};
+            QPoint    m_lastBrushCell{-1, -1};
+            bool      m_rectActive{false};
+            QPoint    m_rectAnchor;
+            QPoint    m_rectCursor;
+            QPolygon  m_polygon;
+            Side      m_shapeSide{Side::A};
+
+            OverlayMode                m_overlayMode{OverlayMode::SIDE};
+            mutable std::vector<float> m_rowValues; // bufor wartości nakładki dla jednego wiersza
+            mutable std::vector<Side>  m_rowSides;  // bufor stron dla jednego wiersza
+
+            const std::vector<uint8_t>* m_sideOverride{nullptr};
+
             QSet<int>          m_selectedStateIds;
             int                m_selectedSingleStateId{-1};
             QHash<int, QColor> m_coloredStates;
             int                m_hoverSid{-1};
 
-            mutable QImage m_cellsImage;
+            mutable QImage           m_cellsImage;
+            mutable CellImagePyramid m_cellsPyramid;
 
             struct Geometry
             {
@@ -73,16 +103,25 @@ namespace app::ui
                     float originYCenter;
             };
 
-            void drawGrid(QPainter& painter) const;
+            void drawGrid(QPainter& painter, const QRect& visibleCells) const;
             bool canPaint() const noexcept;
-            void drawCells(QPainter& painter, const QRectF& destRectF) const;
+            void drawCells(QPainter&     painter,
+                           const QRectF& destRectF,
+                           const QRect&  visibleCells) const;
             void drawOutlines(QPainter& painter, const QRectF& destRectF) const;
             void drawOuterFrame(QPainter& painter) const;
+            void drawPaintPreview(QPainter& painter, const QRectF& destRectF) const;
+            void beginPaintAt(const QPointF& pos, Qt::MouseButton button);
             void applyBrushAt(const QPointF& pos, Qt::MouseButtons buttons);
+            void cancelShape() noexcept;
             void updateCellInfoAt(const QPointF& position);
 
             [[nodiscard]] QRectF mapDestRect() const;
-            void                 rebuildCellsImageIfNeeded() const;
+            [[nodiscard]] QRect  visibleCellRect(const QRectF& destRectF, const QRectF& area) const;
+            [[nodiscard]] QRectF cellsWidgetRect(const QRectF& destRectF, const QRect& cells) const;
+            void                 rebuildCellsImageIfNeeded(const QRect& visibleCells) const;
+            void                 fillOverlayRow(int y, int x0, int x1) const;
+            void                 fillSideRow(int y, int x0, int x1) const;
 
             [[nodiscard]] QPoint  productPointFromWidgetPos(QPointF position) const;
             [[nodiscard]] uint8_t stateAtWidgetPos(QPointF position) const;
@@ -5,6 +5,8 @@
 #include "Simulation.hpp"
 #include "SimulationControlWidget.hpp"
 #include "StatsWidget.hpp"
+#include "TrajectoryReader.hpp"
+#include "TrajectoryRecorder.hpp"
 #include "UsMap.hpp"
 #include "WorldPhysicsWidget.hpp"
 
@@ -38,6 +40,16 @@ namespace app::ui
                     QTimer*                     timer{};
                     QElapsedTimer               fpsTimer;
                     int                         fpsFrameCount{};
+                    int                         fpsStepCount{};
+
+                    bool   turbo{false};
+                    int    fixedStepsPerFrame{}; // 0 = adaptacyjnie z budżetu klatki
+                    int    stepsPerFrame{1};
+                    double avgStepMs{};
+
+                    // Po simulation, żeby zatrzymać nagrywanie zanim symulacja zniknie
+                    TrajectoryRecorder trajectory;
+                    TrajectoryReader   replay;
             } model;
 
             struct ui
@@ -54,16 +66,32 @@ namespace app::ui
 
                     QLabel*    scenarioPresetLabel{nullptr};
                     QComboBox* scenarioPresetCombo{nullptr};
+                    QLabel*    resolutionLabel{nullptr};
+                    QComboBox* resolutionCombo{nullptr};
 
                     QLabel*      playerSettingsLabel{nullptr};
                     QCheckBox*   gridToggle{nullptr};
                     QCheckBox*   mapToggle{nullptr};
                     QCheckBox*   paintToggle{nullptr};
+                    QComboBox*   paintToolCombo{nullptr};
+                    QSpinBox*    brushRadiusSpin{nullptr};
+                    QSpinBox*    seedPercentSpin{nullptr};
+                    QLabel*      overlayLabel{nullptr};
+                    QComboBox*   overlayCombo{nullptr};
                     QPushButton* toggleViewButton{nullptr};
+                    QPushButton* saveCheckpointButton{nullptr};
+                    QPushButton* loadCheckpointButton{nullptr};
+                    QPushButton* recordTrajectoryButton{nullptr};
 
                     QPushButton* physicsButton{nullptr};
                     QDockWidget* physicsDock{nullptr};
 
+                    // Odtwarzanie nagrania (pasek pod siatką)
+                    QPushButton* replayOpenButton{nullptr};
+                    QPushButton* replayCloseButton{nullptr};
+                    QSlider*     replaySlider{nullptr};
+                    QLabel*      replayLabel{nullptr};
+
                     QLabel* cellInfoLabel{nullptr};
                     QLabel* iterationLabel{nullptr};
                     QLabel* fpsLabel{nullptr};
@@ -89,6 +117,8 @@ namespace app::ui
             void wireTogglesAndView();
 
             void doStep();
+            void doTurboFrame();
+            void adaptStepsPerFrame(double stepMs);
             void updateIterationLabel();
             void updateOverlayLabelsPosition();
             void countFps();
@@ -97,13 +127,27 @@ namespace app::ui
 
             void updateStats();
             void clearStats();
+            void stopTrajectoryRecording();
+            void closeReplay();
+            void applyPaint(const QRect& dirtyCells);
+            void fillStatsFromReplay();
 
         private slots:
             void onStartClicked();
             void onResetClicked();
             void onStepClicked();
+            void onTimerTick();
             void onSimulationSpeedChanged(int speed);
+            void onTurboChanged(bool on);
+            void onStepsPerFrameChanged(int steps);
             void onNeighbourhoodChanged(int index);
+            void onResolutionChanged(int index);
             void onToggleView(bool checked);
+            void onOverlayChanged(int index);
+            void onSaveCheckpoint();
+            void onLoadCheckpoint();
+            void onRecordTrajectory();
+            void onOpenReplay();
+            void onReplaySeek(int iteration);
     };
 } // namespace app::ui
@@ -0,0 +1,169 @@
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Proste dzielenie pracy między wątki: zakres [0, count) jest cięty na ciągłe, rozłączne
+// kawałki, po jednym na workera, a wątek wywołujący liczy pierwszy z nich. Worker może więc
+// bez synchronizacji pisać do swoich elementów i do własnych buforów (np. histogramów
+// indeksowanych numerem workera), które scala się po powrocie.
+namespace Parallel
+{
+    inline unsigned maxWorkers()
+    {
+        return std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    // Liczba workerów tak, żeby każdy dostał co najmniej minPerWorker elementów
+    inline unsigned workerCount(std::size_t count, std::size_t minPerWorker)
+    {
+        const std::size_t byWork = count / std::max<std::size_t>(1, minPerWorker);
+        return static_cast<unsigned>(
+            std::clamp<std::size_t>(byWork, 1, static_cast<std::size_t>(maxWorkers())));
+    }
+
+    // fn(worker, begin, end) dla worker w [0, workers)
+    template <typename Fn> void forRanges(std::size_t count, unsigned workers, Fn&& fn)
+    {
+        workers                 = std::max(1u, workers);
+        const std::size_t chunk = (count + workers - 1) / workers;
+
+        std::vector<std::thread> threads;
+        threads.reserve(workers - 1);
+        for (unsigned worker = 1; worker < workers; ++worker)
+        {
+            const std::size_t begin = std::min(count, worker * chunk);
+            const std::size_t end   = std::min(count, begin + chunk);
+            threads.emplace_back([&fn, worker, begin, end] { fn(worker, begin, end); });
+        }
+
+        fn(0u, std::size_t{0}, std::min(count, chunk));
+
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+    }
+
+    // To samo co forRanges, ale wątki żyją między wywołaniami i czekają na kolejne zadanie -
+    // na gorącej ścieżce (krok symulacji w turbo) nie tworzymy i nie łączymy wątków co
+    // wywołanie. Wątki powstają przy pierwszej potrzebie; pula nie jest reentrantna i jest
+    // używana z jednego wątku wywołującego.
+    class WorkerPool
+    {
+        public:
+            WorkerPool() = default;
+            WorkerPool(const WorkerPool&)            = delete;
+            WorkerPool& operator=(const WorkerPool&) = delete;
+
+            ~WorkerPool()
+            {
+                {
+                    const std::lock_guard lock(m_mutex);
+                    m_stop = true;
+                }
+                m_wake.notify_all();
+                for (auto& thread : m_threads)
+                {
+                    thread.join();
+                }
+            }
+
+            // fn(worker, begin, end) dla worker w [0, workers), podział jak w forRanges
+            template <typename Fn> void forRanges(std::size_t count, unsigned workers, Fn&& fn)
+            {
+                workers                 = std::max(1u, workers);
+                const std::size_t chunk = (count + workers - 1) / workers;
+                auto runWorker          = [&](unsigned worker)
+                {
+                    const std::size_t begin = std::min(count, worker * chunk);
+                    const std::size_t end   = std::min(count, begin + chunk);
+                    fn(worker, begin, end);
+                };
+                if (workers == 1)
+                {
+                    runWorker(0u);
+                    return;
+                }
+
+                ensureThreads(workers - 1);
+                {
+                    const std::lock_guard lock(m_mutex);
+                    m_context = &runWorker;
+                    m_invoke  = [](void* context, unsigned worker)
+                    { (*static_cast<decltype(runWorker)*>(context))(worker); };
+                    m_workers = workers;
+                    m_pending = workers - 1;
+                    ++m_generation;
+                }
+                m_wake.notify_all();
+
+                runWorker(0u);
+
+                std::unique_lock lock(m_mutex);
+                m_done.wait(lock, [this] { return m_pending == 0; });
+            }
+
+        private:
+            void ensureThreads(unsigned count)
+            {
+                while (m_threads.size() < count)
+                {
+                    // Nowy wątek zna bieżącą generację, więc czeka na następne zadanie
+                    const auto     worker = static_cast<unsigned>(m_threads.size()) + 1;
+                    const uint64_t seen   = m_generation;
+                    m_threads.emplace_back([this, worker, seen] { workerLoop(worker, seen); });
+                }
+            }
+
+            void workerLoop(unsigned worker, uint64_t seen)
+            {
+                for (;;)
+                {
+                    void* context = nullptr;
+                    void (*invoke)(void*, unsigned) = nullptr;
+                    {
+                        std::unique_lock lock(m_mutex);
+                        m_wake.wait(lock, [&] { return m_stop or m_generation not_eq seen; });
+                        if (m_stop)
+                        {
+                            return;
+                        }
+                        seen = m_generation;
+                        if (worker >= m_workers)
+                        {
+                            continue;
+                        }
+                        context = m_context;
+                        invoke  = m_invoke;
+                    }
+
+                    invoke(context, worker);
+
+                    const std::lock_guard lock(m_mutex);
+                    if (--m_pending == 0)
+                    {
+                        m_done.notify_one();
+                    }
+                }
+            }
+
+            std::vector<std::thread> m_threads;
+            std::mutex               m_mutex;
+            std::condition_variable  m_wake;
+            std::condition_variable  m_done;
+
+            // Bieżące zadanie: wywołanie runWorker z forRanges bez alokacji
+            void* m_context                   = nullptr;
+            void (*m_invoke)(void*, unsigned) = nullptr;
+            unsigned m_workers                = 0;
+            unsigned m_pending                = 0;
+            uint64_t m_generation             = 0;
+            bool     m_stop                   = false;
+    };
+} // namespace Parallel
@@ -2,9 +2,12 @@
 #include <Model.hpp>
 #include <QGroupBox>
 #include <QLabel>
+#include <QListWidget>
 #include <QSlider>
+#include <QStringList>
 #include <QVBoxLayout>
 #include <QWidget>
+#include <vector>
 
 class PlayerControlWidget : public QWidget
 {
@@ -13,10 +16,17 @@ class PlayerControlWidget : public QWidget
         explicit PlayerControlWidget(const QString& playerName, QWidget* parent = nullptr);
 
         [[nodiscard]] Controls getControls() const;
+        void                   setControls(const Controls& controls); // np. z checkpointu
 
         void updateBudgetDisplay(float currentBudget, float plannedCost);
+
+        // Stany mapy do wyboru celu kampanii; bez regionów grupa jest ukryta
+        void setRegions(const QStringList& codes, const QStringList& names);
+        // Waga per stan (1 = zaznaczony); pusta, gdy zaznaczone wszystkie albo żaden
+        [[nodiscard]] std::vector<float> getRegionWeights() const;
     signals:
         void controlsChanged();
+        void targetingChanged();
 
     private:
         QGroupBox*
@@ -28,4 +38,7 @@ class PlayerControlWidget : public QWidget
 
         QLabel* m_budgetLabel;
         QLabel* m_costLabel;
+
+        QGroupBox*   m_targetBox;
+        QListWidget* m_targetList;
 };
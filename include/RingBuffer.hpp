@@ -0,0 +1,77 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+// Bufor cykliczny o stałej pojemności; po zapełnieniu nadpisuje najstarsze elementy.
+// Indeksowanie od najstarszego (0) do najnowszego (size() - 1).
+template <typename T> class RingBuffer
+{
+    public:
+        explicit RingBuffer(std::size_t capacity = 0) : m_data(capacity) {}
+
+        void push(const T& value)
+        {
+            if (m_data.empty())
+            {
+                return;
+            }
+
+            m_data[m_head] = value;
+            m_head         = (m_head + 1) % m_data.size();
+            if (m_size < m_data.size())
+            {
+                ++m_size;
+            }
+        }
+
+        void clear()
+        {
+            m_head = 0;
+            m_size = 0;
+        }
+
+        void reset(std::size_t capacity)
+        {
+            m_data.assign(capacity, T{});
+            clear();
+        }
+
+        [[nodiscard]] std::size_t size() const { return m_size; }
+        [[nodiscard]] std::size_t capacity() const { return m_data.size(); }
+        [[nodiscard]] bool        empty() const { return m_size == 0; }
+
+        [[nodiscard]] const T& operator[](std::size_t i) const
+        {
+            return m_data[(m_head + m_data.size() - m_size + i) % m_data.size()];
+        }
+
+        [[nodiscard]] const T& front() const { return (*this)[0]; }
+        [[nodiscard]] const T& back() const { return (*this)[m_size - 1]; }
+
+        // Dopisuje zawartość (od najstarszego) do kontenera, w dwóch ciągłych blokach
+        template <typename Container> void appendTo(Container& out) const
+        {
+            if (m_size == 0)
+            {
+                return;
+            }
+
+            const std::size_t start = (m_head + m_data.size() - m_size) % m_data.size();
+            const std::size_t first = std::min(m_size, m_data.size() - start);
+            for (std::size_t i = 0; i < first; ++i)
+            {
+                out.push_back(m_data[start + i]);
+            }
+            for (std::size_t i = 0; i < m_size - first; ++i)
+            {
+                out.push_back(m_data[i]);
+            }
+        }
+
+    private:
+        std::vector<T> m_data;
+        std::size_t    m_head = 0; // następna pozycja do zapisu
+        std::size_t    m_size = 0;
+};
@@ -1,9 +1,18 @@
 #pragma once
+#include "GridView.hpp"
 #include "Model.hpp"
+#include "Parallel.hpp"
 #include "SimulationResults.hpp"
 #include "Types.hpp"
 
+#include <QPoint>
+#include <QPolygon>
+#include <QRect>
+#include <QString>
+#include <array>
+#include <cstddef>
 #include <random>
+#include <span>
 #include <vector>
 
 class Simulation
@@ -14,8 +23,32 @@ class Simulation
         void setParameters(const BaseParameters&);
         void setPlayers(const Player& A, const Player& B);
         void setNeighbourhoodType(NeighbourhoodType type);
+        void setFieldCapture(bool on);
+        void setChangeCapture(bool on);
+        // Przypisanie komórek do stanów mapy (UsMap::Products::stateIds); komórki o stateId
+        // < regionCount dostają statystyki per stan. Zachowywane przy reset().
+        void setStateIds(const std::vector<uint8_t>& stateIds, int regionCount);
+        // Rozdział kampanii strony na stany: waga per stateId (regionCount wag), pusta lista
+        // = kampania ogólnokrajowa. Łączny wysiłek się nie zmienia, tylko trafia do stanów
+        // proporcjonalnie do wagi na komórkę; komórki poza wybranymi stanami nic nie dostają.
+        void setRegionAllocation(Side side, std::vector<float> weights);
+        // Maska mapy (UsMap::Products::activeStates): komórki z 0 wypadają z symulacji, a krok
+        // ich w ogóle nie odwiedza. Pusta maska = cała siatka. Działa od następnego reset().
+        void setActiveMask(const std::vector<uint8_t>& mask);
+        [[nodiscard]] const std::vector<uint8_t>& getActiveMask() const;
         void reset();
+        // Zmiana rozdzielczości w trakcie przebiegu: każda nowa komórka bierze blok starych,
+        // które pokrywa (większościowa strona, średni próg i histereza). Maska obowiązuje od
+        // razu; stany trzeba potem podać na nowo przez setStateIds() w nowym rozmiarze.
+        void resize(int cols, int rows, const std::vector<uint8_t>& activeMask = {});
+        // Warunki początkowe, losowane bez zwracania: dokładnie tyle komórek strony, ile
+        // zmieści się w wolnych (NONE) komórkach. Progi losuje osobno setThresholdRandomly().
         void seedRandomly(int countA, int countB);
+        void seedClustered(int countA, int countB, int clusters); // plamy wokół środków
+        void seedGradient(int countA, int countB); // A gęstsze na zachodzie, B na wschodzie
+        // Limity per stateId (brakujące = 0), każdy przycięty do wolnych komórek stanu
+        void seedStateQuotas(std::span<const int> quotaA, std::span<const int> quotaB);
+        void setSeedPattern(SeedPattern pattern); // generator używany przez reset()
         void setThresholdRandomly();
 
         void step();
@@ -24,23 +57,82 @@ class Simulation
         [[nodiscard]] int getCols() const;
         [[nodiscard]] int getRows() const;
 
-        [[nodiscard]] const StepStats& getlastStepStats() const;
+        // Stan trzymany jest tylko dla aktywnych komórek, numerowanych gęsto po odcinkach
+        // wierszy (wiersz po wierszu, więc sąsiedzi w wierszu są sąsiadami w pamięci).
+        // Bez maski numeracja pokrywa się z y * cols + x. Odczyt z zewnątrz przez view();
+        // wersja rośnie przy każdej zmianie stanu komórek.
+        [[nodiscard]] GridView view() const;
+        [[nodiscard]] uint64_t getVersion() const;
+
+        [[nodiscard]] const StepStats&      getlastStepStats() const;
+        [[nodiscard]] const BaseParameters& getParameters() const;
+
+        // Statystyki per stan z ostatniego kroku, indeksowane stateId
+        [[nodiscard]] int                             getRegionCount() const;
+        [[nodiscard]] const std::vector<RegionStats>& getLastRegionStats() const;
+
+        // Pole h z ostatniego kroku (wypełniane tylko przy włączonym setFieldCapture);
+        // to i iteracje ostatniej zmiany są indeksowane gęsto, jak GridView::cells()
+        [[nodiscard]] bool                      isFieldCaptured() const;
+        [[nodiscard]] const std::vector<float>& getField() const;
+        [[nodiscard]] const std::vector<int>&   getLastFlipIterations() const;
+
+        // Komórki, które zmieniły stronę w ostatnim kroku, jako (indeks << 2) | nowa strona,
+        // rosnąco po indeksie (wypełniane tylko przy włączonym setChangeCapture)
+        [[nodiscard]] const std::vector<uint32_t>& getChangedCells() const;
+        void                                       copySides(std::vector<uint8_t>& out) const;
 
         [[nodiscard]] Player getPlayerA() const;
         [[nodiscard]] Player getPlayerB() const;
 
-        [[nodiscard]] CellData&       cellAt(int x, int y);
+        [[nodiscard]] NeighbourhoodType getNeighbourhoodType() const;
+
+        // Komórka spoza maski to nieaktywna komórka domyślna
         [[nodiscard]] const CellData& cellAt(int x, int y) const;
+        bool                          setCellSide(int x, int y, Side side); // false poza maską
+
+        // Malowanie hurtowe: jedna operacja na wiele komórek, tło maski jest pomijane.
+        // Zwracają prostokąt zmienionych komórek (pusty, gdy nic się nie zmieniło), żeby
+        // widok odświeżył tylko ten fragment.
+        QRect paintBrush(QPoint from, QPoint to, int radius, Side side); // odcinek pędzla
+        QRect paintRect(const QRect& cells, Side side);
+        QRect paintPolygon(const QPolygon& vertices, Side side); // wierzchołki w komórkach
+        QRect paintState(uint8_t stateId, Side side);
+        QRect seedState(uint8_t stateId, Side side, double fraction); // losowy ułamek stanu
+
+        // Pełny stan (siatka, tracker, graf, gracze, parametry, RNG) w pliku binarnym;
+        // implementacja w SimulationCheckpoint.cpp
+        [[nodiscard]] bool saveCheckpoint(const QString& path,
+                                          QString*       errorMessage = nullptr) const;
+        [[nodiscard]] bool loadCheckpoint(const QString& path, QString* errorMessage = nullptr);
 
     private:
+        // Częściowe wyniki jednego wątku kroku, scalane po przejściu całej siatki
+        struct StepWorker
+        {
+                StepStats                stats;
+                std::vector<RegionStats> regions;
+                std::vector<uint32_t>    changes;
+        };
+
         [[nodiscard]] inline std::size_t idx(int x, int y) const
         {
             return static_cast<std::size_t>(y) * static_cast<std::size_t>(m_cols) +
                    static_cast<std::size_t>(x);
         }
+        [[nodiscard]] std::size_t gridSize() const { return idx(0, m_rows); }
+        [[nodiscard]] std::span<const CellSpan> rowSpans(int y) const;
+        [[nodiscard]] std::ptrdiff_t            denseIndex(int x, int y) const; // -1 = brak
         [[nodiscard]] GlobalSignals calculateCampaignImpact(CampaignDiag& outDiag);
 
-        [[nodiscard]] float calculateNeighbourInfluence(int x, int y) const;
+        // Tablica sygnałów indeksowana stateId (256 pozycji, jeden odczyt na komórkę w kroku)
+        using SignalTable = std::array<GlobalSignals, 256>;
+        using RegionGains = std::array<float, 256>;
+
+        void regionGains(const std::vector<float>& weights, RegionGains& out) const;
+        void buildSignalTable(const CampaignDiag& diag);
+
+        [[nodiscard]] float calculateNeighbourInfluence(std::size_t i) const;
         [[nodiscard]] float calculateSocialInfluence(std::size_t i) const;
         [[nodiscard]] float applyBroadcastPersuasionForNeutrals(
             const CellData& currentCell, float baseH, const GlobalSignals& globalSignals) const;
@@ -57,6 +149,17 @@ class Simulation
                                     float           hysMax);
         void updateCellState(const CellData& currentCell, CellData& nextCell, float h);
         void updateFlipTracker(std::size_t i, Side from, Side to, StepTransitions& trans);
+        void updateRows(int yBegin, int yEnd, StepWorker& worker);
+        void paintRow(int y, int x0, int x1, Side side, QRect& dirty);
+        void applyStateIds();
+        void seedInitialState();
+        // Wspólny silnik seedów: klasa komórki classOf(x, y, i) < classes, quotas(pojemności
+        // klas) zwraca limity A i B per klasa
+        template <typename ClassOf, typename QuotaFn>
+        void seedByClass(std::size_t classes, ClassOf classOf, QuotaFn quotas);
+        void rebuildActiveSpans(const std::vector<uint8_t>& activePlane);
+        void allocateCells();
+        void buildNeighbourTable();
         void computeGridSpatialMetrics(const std::vector<CellData>& grid,
                                        StepStats&                   outStats) const;
 
@@ -66,11 +169,41 @@ class Simulation
         std::vector<CellData> m_currentGrid;
         std::vector<CellData> m_nextGrid;
         int                   m_iteration{};
+        uint64_t              m_version{}; // każda zmiana stanu komórek, patrz GridView
 
         StepStats m_lastStepStats{};
 
+        std::vector<uint8_t>     m_stateIds;
+        int                      m_regionCount{0};
+        std::vector<RegionStats> m_lastRegionStats;
+        std::vector<StepWorker>  m_stepWorkers; // bufory wątków kroku, używane ponownie
+        Parallel::WorkerPool     m_workerPool;  // wątki kroku i losowania, żyją z symulacją
+        std::vector<int>         m_regionCells; // liczba komórek każdego stanu
+
+        // Aktywne komórki jako odcinki wierszy (CSR): odcinki wiersza y to
+        // m_activeSpans[m_rowSpanStart[y] .. m_rowSpanStart[y + 1])
+        std::vector<uint8_t>     m_activeMask;
+        std::vector<CellSpan>    m_activeSpans;
+        std::vector<std::size_t> m_rowSpanStart;
+        std::size_t              m_cellCount{0};
+
+        // Sąsiedzi lokalni w indeksach gęstych, m_neighbourCount na komórkę, -1 = brak
+        std::vector<int32_t> m_neighbours;
+        std::size_t          m_neighbourCount{0};
+
+        std::vector<float> m_allocationA;
+        std::vector<float> m_allocationB;
+        SignalTable        m_signalTable{};
+
         std::vector<FlipTracker> m_flipTracker;
 
+        bool               m_captureField{false};
+        std::vector<float> m_field;
+        std::vector<int>   m_lastFlipIteration;
+
+        bool                  m_captureChanges{false};
+        std::vector<uint32_t> m_changedCells;
+
         BaseParameters m_parameters{};
         Player         m_playerA{};
         Player         m_playerB{};
@@ -78,9 +211,13 @@ class Simulation
         float m_broadcastStockA = 0.0f;
         float m_broadcastStockB = 0.0f;
 
-        std::vector<std::vector<std::size_t>> m_socialGraph;
+        // Graf społeczny w indeksach gęstych jako CSR: sąsiedzi komórki i to
+        // m_socialTargets[m_socialOffsets[i] .. m_socialOffsets[i + 1])
+        std::vector<uint32_t> m_socialOffsets;
+        std::vector<uint32_t> m_socialTargets;
 
         NeighbourhoodType m_neighbourhoodType{};
+        SeedPattern       m_seedPattern{SeedPattern::UNIFORM};
 
         std::mt19937 m_rng;
 };
@@ -1,8 +1,10 @@
 #pragma once
+#include <QCheckBox>
 #include <QComboBox>
 #include <QLabel>
 #include <QPushButton>
 #include <QSlider>
+#include <QSpinBox>
 #include <QWidget>
 
 class SimulationControlWidget : public QWidget
@@ -12,6 +14,8 @@ class SimulationControlWidget : public QWidget
         explicit SimulationControlWidget(QWidget* parent = nullptr);
 
         int  getSpeed() const;
+        bool isTurbo() const;
+        int  getStepsPerFrame() const;
         void setNeighbourhood(int index);
         void updateState(bool running);
 
@@ -20,6 +24,8 @@ class SimulationControlWidget : public QWidget
         void resetRequested();
         void stepRequested();
         void speedChanged(int newSpeed);
+        void turboChanged(bool on);
+        void stepsPerFrameChanged(int steps); // 0 = auto
         void neighbourhoodChanged(int index);
 
     private:
@@ -27,5 +33,7 @@ class SimulationControlWidget : public QWidget
         QPushButton* m_resetButton{nullptr};
         QPushButton* m_stepButton{nullptr};
         QSlider*     m_simulationSpeedSlider{nullptr};
+        QCheckBox*   m_turboCheck{nullptr};
+        QSpinBox*    m_stepsPerFrameSpin{nullptr};
         QComboBox*   m_neighbourhoodCombo{nullptr};
 };
@@ -1,8 +1,28 @@
+#pragma once
+
 #include "Model.hpp"
 #include "Types.hpp"
 
+#include <cmath>
 #include <cstdint>
 
+// Sumy histerezy liczone w stałym przecinku (krok 2^-32): dodawanie liczb całkowitych jest
+// łączne, więc średnie nie zależą od podziału siatki między wątki (czyli od maszyny)
+namespace HysSum
+{
+    inline constexpr double scale = 4294967296.0;
+
+    inline int64_t toFixed(double hysteresis)
+    {
+        return std::llround(hysteresis * scale);
+    }
+
+    inline double average(int64_t sum, int count)
+    {
+        return (count > 0) ? static_cast<double>(sum) / scale / count : 0.0;
+    }
+} // namespace HysSum
+
 struct CampaignDiag
 {
         float plannedCostA = 0, plannedCostB = 0;
@@ -69,6 +89,16 @@ struct StepTransitions
                 ++B_to_NONE;
             }
         }
+
+        void add(const StepTransitions& other)
+        {
+            N_to_A += other.N_to_A;
+            N_to_B += other.N_to_B;
+            A_to_NONE += other.A_to_NONE;
+            B_to_NONE += other.B_to_NONE;
+            A_to_B += other.A_to_B;
+            B_to_A += other.B_to_A;
+        }
 };
 
 struct FlipTracker
@@ -92,8 +122,8 @@ struct StepStats
         double localHomophily  = 0.0; // like / total
         double boundaryRate    = 0.0; // unlike / total
 
-        double internalSumHysA = 0;
-        double internalSumHysB = 0;
+        int64_t internalSumHysA = 0; // HysSum
+        int64_t internalSumHysB = 0;
 
         CampaignDiag    campaign;
         StepTransitions trans;
@@ -114,11 +144,11 @@ struct StepStats
             {
             case Side::A:
                 ++countA;
-                internalSumHysA += cell.hysteresis;
+                internalSumHysA += HysSum::toFixed(cell.hysteresis);
                 break;
             case Side::B:
                 ++countB;
-                internalSumHysB += cell.hysteresis;
+                internalSumHysB += HysSum::toFixed(cell.hysteresis);
                 break;
             case Side::NONE:
                 ++countN;
@@ -126,6 +156,18 @@ struct StepStats
             }
         }
 
+        // Dolicza liczniki policzone przez jeden wątek kroku
+        void addCounts(const StepStats& part)
+        {
+            active += part.active;
+            countA += part.countA;
+            countB += part.countB;
+            countN += part.countN;
+            internalSumHysA += part.internalSumHysA;
+            internalSumHysB += part.internalSumHysB;
+            trans.add(part.trans);
+        }
+
         void finalize()
         {
             if (active > 0)
@@ -139,8 +181,8 @@ struct StepStats
                 shareA = shareB = shareN = 0.0;
             }
 
-            avgHysA = (countA > 0) ? internalSumHysA / countA : 0.0;
-            avgHysB = (countB > 0) ? internalSumHysB / countB : 0.0;
+            avgHysA = HysSum::average(internalSumHysA, countA);
+            avgHysB = HysSum::average(internalSumHysB, countB);
 
             // Schelling
             gridEdgesTotal = gridEdgesLike + gridEdgesUnlike;
@@ -156,3 +198,55 @@ struct StepStats
             }
         }
 };
+
+// Agregaty jednego stanu USA (CellData::stateId) w kroku, liczone w tym samym przebiegu
+// co StepStats
+struct RegionStats
+{
+        int    active = 0, countA = 0, countB = 0, countN = 0;
+        double shareA = 0, shareB = 0, shareN = 0;
+
+        double  avgHysA = 0, avgHysB = 0;
+        int64_t sumHysA = 0, sumHysB = 0; // HysSum
+
+        StepTransitions trans;
+
+        void addCell(const CellData& cell)
+        {
+            ++active;
+            switch (cell.side)
+            {
+            case Side::A:
+                ++countA;
+                sumHysA += HysSum::toFixed(cell.hysteresis);
+                break;
+            case Side::B:
+                ++countB;
+                sumHysB += HysSum::toFixed(cell.hysteresis);
+                break;
+            case Side::NONE:
+                ++countN;
+                break;
+            }
+        }
+
+        void add(const RegionStats& other)
+        {
+            active += other.active;
+            countA += other.countA;
+            countB += other.countB;
+            countN += other.countN;
+            sumHysA += other.sumHysA;
+            sumHysB += other.sumHysB;
+            trans.add(other.trans);
+        }
+
+        void finalize()
+        {
+            shareA  = (active > 0) ? static_cast<double>(countA) / active : 0.0;
+            shareB  = (active > 0) ? static_cast<double>(countB) / active : 0.0;
+            shareN  = (active > 0) ? static_cast<double>(countN) / active : 0.0;
+            avgHysA = HysSum::average(sumHysA, countA);
+            avgHysB = HysSum::average(sumHysB, countB);
+        }
+};
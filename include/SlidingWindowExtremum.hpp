@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+
+// Maksimum/minimum z ostatnich `window` wartości w O(1) zamortyzowanym na push.
+// Kolejka monotoniczna: element zdominowany przez nowszy nigdy już nie będzie ekstremum,
+// więc jest usuwany od tyłu; od przodu wypadają elementy spoza okna.
+template <typename T, typename Dominates> class SlidingWindowExtremum
+{
+    public:
+        explicit SlidingWindowExtremum(std::size_t window = 1) : m_window(window) {}
+
+        void push(T value)
+        {
+            while (not m_queue.empty() and Dominates{}(value, m_queue.back().value))
+            {
+                m_queue.pop_back();
+            }
+            m_queue.push_back(Entry{m_count, value});
+            ++m_count;
+
+            while (m_queue.front().index + m_window < m_count)
+            {
+                m_queue.pop_front();
+            }
+        }
+
+        void clear()
+        {
+            m_queue.clear();
+            m_count = 0;
+        }
+
+        void setWindow(std::size_t window)
+        {
+            m_window = window;
+            clear();
+        }
+
+        [[nodiscard]] bool empty() const { return m_queue.empty(); }
+        [[nodiscard]] T    value(T fallback = T{}) const
+        {
+            return m_queue.empty() ? fallback : m_queue.front().value;
+        }
+
+    private:
+        struct Entry
+        {
+                uint64_t index;
+                T        value;
+        };
+
+        std::deque<Entry> m_queue;
+        std::size_t       m_window;
+        uint64_t          m_count = 0;
+};
+
+template <typename T> using SlidingWindowMax = SlidingWindowExtremum<T, std::greater_equal<T>>;
+template <typename T> using SlidingWindowMin = SlidingWindowExtremum<T, std::less_equal<T>>;
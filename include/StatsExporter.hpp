@@ -0,0 +1,83 @@
+#pragma once
+
+#include "SimulationResults.hpp"
+
+#include <QFile>
+#include <QString>
+#include <QStringList>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class QTextStream;
+
+// Strumieniowy zapis StepStats w tle: GUI tylko dokłada wiersz do kolejki,
+// a wątek zapisu formatuje i zapisuje paczki (po exportBatchRows wierszy albo co
+// exportFlushIntervalMs), więc po awarii traci się najwyżej ostatnią chwilę przebiegu.
+//
+// Format BINARY (little-endian, kolumny jak w StatsSchema + parametry jako FLOAT32):
+//   nagłówek: magic "PSSTATS\0", u32 wersja, u32 liczba kolumn,
+//             dla każdej kolumny: u8 typ (StatsSchema::ColumnType), u8 długość nazwy, nazwa
+//   bloki:    u32 liczba wierszy, potem kolejno wartości każdej kolumny dla tych wierszy
+//
+// Gdy ustawiono nazwy regionów, obok powstaje <plik>.states.csv ze statystykami per stan
+// (StatsSchema::regionCsvHeader), niezależnie od formatu głównego pliku.
+class StatsExporter
+{
+    public:
+        enum class Format : uint8_t
+        {
+            CSV    = 0,
+            BINARY = 1
+        };
+
+        static constexpr char     kBinaryMagic[8] = {'P', 'S', 'S', 'T', 'A', 'T', 'S', '\0'};
+        static constexpr uint32_t kBinaryVersion  = 1;
+
+        StatsExporter() = default;
+        ~StatsExporter();
+
+        StatsExporter(const StatsExporter&)            = delete;
+        StatsExporter& operator=(const StatsExporter&) = delete;
+
+        bool start(const QString& path, Format format, QString* errorMessage = nullptr);
+        void stop(); // dopisuje resztę kolejki i czeka na wątek
+        void push(const StepStats& s, const std::vector<RegionStats>& regions = {});
+
+        // Nazwy regionów dla pliku per stan; pusta lista = bez tego pliku
+        void setRegionNames(QStringList names);
+
+        [[nodiscard]] bool isRunning() const;
+        [[nodiscard]] bool hasFailed() const;
+
+    private:
+        struct Row
+        {
+                StepStats                stats;
+                std::vector<RegionStats> regions;
+        };
+
+        void run();
+        void writeCsvBatch(QTextStream& out, const std::vector<Row>& batch);
+        void writeBinaryBatch(const std::vector<Row>& batch);
+        void writeRegionBatch(QTextStream& out, const std::vector<Row>& batch);
+        [[nodiscard]] bool writeHeader();
+        [[nodiscard]] bool openRegionFile(const QString& path, QString* errorMessage);
+
+        QFile       m_file;
+        QFile       m_regionFile;
+        QStringList m_regionNames; // kopiowane do wątku zapisu tylko przy start()
+        QStringList m_writerRegionNames;
+        Format m_format  = Format::CSV;
+        bool   m_running = false; // tylko wątek GUI
+
+        std::thread             m_thread;
+        std::mutex              m_mutex;
+        std::condition_variable m_wake;
+        std::vector<Row>        m_pending;
+        bool                    m_stopRequested = false;
+        std::atomic<bool>       m_failed{false};
+};
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "Model.hpp"
+#include "SimulationResults.hpp"
+
+#include <QTemporaryFile>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Kolumnowa historia StepStats na cały przebieg.
+// Każda kolumna schematu (StatsSchema) to osobna tablica o typie ze schematu (int32/float/
+// double) zamiast pełnej struktury na wiersz; kolumny wyliczane nie są zapisywane.
+// Migawki parametrów zmieniają się rzadko, więc trzymamy je jako serie (wiersz startowy,
+// parametry). Wiersze są grupowane w porcje po kChunkRows; gdy w pamięci jest więcej niż
+// kMaxResidentChunks pełnych porcji, najstarsza jest zrzucana do pliku tymczasowego
+// i dalej czytana przez QFile::map, więc zużycie RAM nie rośnie z długością przebiegu.
+class StatsHistory
+{
+    public:
+        static constexpr std::size_t kChunkRows         = 4096;
+        static constexpr std::size_t kMaxResidentChunks = 8;
+
+        StatsHistory();
+        ~StatsHistory();
+
+        StatsHistory(const StatsHistory&)            = delete;
+        StatsHistory& operator=(const StatsHistory&) = delete;
+
+        void append(const StepStats& s);
+        void clear();
+
+        [[nodiscard]] std::size_t size() const;
+        [[nodiscard]] bool        empty() const;
+
+        // Odtworzony wiersz (łącznie z paramsSnapshot)
+        [[nodiscard]] StepStats             row(std::size_t index) const;
+        [[nodiscard]] const BaseParameters& paramsAt(std::size_t index) const;
+
+    private:
+        struct Chunk
+        {
+                std::vector<std::vector<std::byte>> columns; // dane w pamięci, puste po zrzucie
+                std::vector<const uchar*>           mapped;  // wskaźniki do zmapowanego pliku
+                std::size_t                         rows    = 0;
+                bool                                spilled = false;
+        };
+
+        struct ParamRun
+        {
+                std::size_t    firstRow = 0;
+                BaseParameters params{};
+        };
+
+        std::vector<std::size_t> m_storedColumns; // indeksy kolumn schematu zapisywanych w porcjach
+        std::vector<std::size_t> m_columnBytes;   // rozmiar elementu zapisywanej kolumny
+        std::vector<Chunk>       m_chunks;
+        std::vector<ParamRun>    m_paramRuns;
+        std::size_t              m_size          = 0;
+        std::size_t              m_firstResident = 0; // pierwsza porcja jeszcze w pamięci
+
+        std::unique_ptr<QTemporaryFile> m_spillFile;
+        bool                            m_spillFailed = false;
+
+        void                      startChunk();
+        void                      spillResidentOverflow();
+        [[nodiscard]] bool        spillChunk(Chunk& chunk);
+        [[nodiscard]] const void* cell(const Chunk& chunk, std::size_t slot, std::size_t r) const;
+};
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "Model.hpp"
+#include "SimulationResults.hpp"
+
+#include <QString>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+class QTextStream;
+
+// Opis kolumn StepStats w kolejności nagłówka CSV. Wspólny dla historii kolumnowej
+// i eksportu, żeby układ kolumn był zdefiniowany w jednym miejscu.
+namespace StatsSchema
+{
+    enum class ColumnType : uint8_t
+    {
+        INT32   = 0,
+        FLOAT32 = 1,
+        FLOAT64 = 2
+    };
+
+    struct Column
+    {
+            const char* name;
+            ColumnType  type;
+            double (*get)(const StepStats&);
+            void (*set)(StepStats&, double); // nullptr = kolumna wyliczana z innych
+    };
+
+    struct ParamColumn
+    {
+            const char* name;
+            float BaseParameters::*member;
+    };
+
+    [[nodiscard]] std::span<const Column>      columns();
+    [[nodiscard]] std::span<const ParamColumn> paramColumns();
+
+    // Nagłówek i wiersz CSV w tym samym formacie, co dotychczasowy eksport
+    [[nodiscard]] QString csvHeader();
+    void                  writeCsvRow(QTextStream& out, const StepStats& s);
+
+    // Statystyki per stan w formacie długim: wiersz na (iteracja, stan)
+    [[nodiscard]] QString regionCsvHeader();
+    void writeRegionCsvRow(QTextStream& out, int iter, const QString& region, const RegionStats& r);
+
+    [[nodiscard]] constexpr std::size_t byteSize(ColumnType type)
+    {
+        return (type == ColumnType::FLOAT64) ? 8 : 4;
+    }
+} // namespace StatsSchema
@@ -1,19 +1,30 @@
 #pragma once
 
+#include "Constants.hpp"
+#include "RingBuffer.hpp"
 #include "Simulation.hpp"
+#include "SlidingWindowExtremum.hpp"
+#include "StatsExporter.hpp"
+#include "StatsHistory.hpp"
+#include "TimeSeriesStore.hpp"
 
+#include <QComboBox>
 #include <QFile>
 #include <QFileDialog>
 #include <QGridLayout>
 #include <QLabel>
+#include <QMessageBox>
 #include <QPushButton>
+#include <QTableWidget>
 #include <QTextStream>
+#include <QTimer>
 #include <QWidget>
 #include <QtCharts/QChart>
 #include <QtCharts/QChartView>
 #include <QtCharts/QLineSeries>
 #include <QtCharts/QValueAxis>
-#include <deque>
+#include <array>
+#include <vector>
 
 namespace app::ui
 {
@@ -24,20 +35,88 @@ namespace app::ui
             explicit StatsWidget(QWidget* parent = nullptr);
 
             void clear();
-            void pushSample(const StepStats& s);
+            void pushSample(const StepStats& s, const std::vector<RegionStats>& regions = {});
+
+            // Wykresy pokazują próbki z odtwarzanego nagrania (bez historii CSV i eksportera);
+            // wykresy bieżącego przebiegu czekają odłożone i wracają w closeReplay()
+            void showReplay(const std::vector<StepStats>& samples);
+            void closeReplay();
+
+            // Regiony (stany mapy) w kolejności stateId; pusta lista chowa tabelę i wykres
+            void setRegions(const QStringList& codes, const QStringList& names);
+
+        protected:
+            void showEvent(QShowEvent* event) override;
 
         private:
-            void trimToMaxPoints();
-            void updateAxesRanges(int lastIter);
+            enum SeriesIndex : std::size_t
+            {
+                kPopA = 0,
+                kPopB,
+                kPopN,
+                kBudgetA,
+                kBudgetB,
+                kBroadcastBias,
+                kDmPressure,
+                kSocialPressure,
+                kSeriesCount
+            };
+
+            struct SeriesBuffer
+            {
+                    QLineSeries*             series{nullptr};
+                    RingBuffer<QPointF>      points;
+                    SlidingWindowMax<double> max; // ekstrema w oknie wykresu, O(1) na próbkę
+                    SlidingWindowMin<double> min;
+                    TimeSeriesStore          history{Config::Stats::historyLevelCapacity};
+            };
+
+            struct Extent
+            {
+                    double min = 0.0;
+                    double max = 0.0;
+            };
+            using Extents = std::array<Extent, kSeriesCount>;
+
+            void bindSeries(SeriesIndex index, QLineSeries* series);
+            void appendPoint(SeriesIndex index, int iter, double value);
+            void appendSample(const StepStats& s);
+            void swapLiveBuffers();
+            static void clearBuffers(std::array<SeriesBuffer, kSeriesCount>& buffers);
+            void resetChartViews();
+            void flushCharts();
+            void flushLiveWindow(Extents& extents, int& minX);
+            void flushHistoryWindow(Extents& extents, int& minX);
+            void flushRegions();
+            void flushRegionChart();
+            void clearRegions();
+
+            void updateAxesRanges(int minX, int lastIter, const Extents& extents);
             void updateHeader(const StepStats& s);
 
             void saveCsv();
+            void toggleRecording();
 
         private:
-            int m_maxPoints = 1200; // ile punktów trzymamy na wykresach
+            int m_maxPoints = Config::Stats::maxChartPoints; // ile punktów trzymamy na wykresach
+            int m_window    = Config::Stats::maxChartPoints; // okno w iteracjach, 0 = całość
+
+            QComboBox* m_windowCombo{nullptr};
+
+            // Punkty wykresów trzymane w buforach cyklicznych; do serii trafiają jednym replace()
+            std::array<SeriesBuffer, kSeriesCount> m_buffers;
+            QTimer*                                m_refreshTimer{nullptr};
+            bool                                   m_chartsDirty{false};
+            StepStats                              m_lastSample{};
+
+            // Dane bieżącego przebiegu odłożone na czas odtwarzania nagrania
+            std::array<SeriesBuffer, kSeriesCount> m_liveBuffers;
+            StepStats                              m_liveSample{};
+            bool                                   m_replaying{false};
 
             QLabel*      m_header{nullptr};
             QPushButton* m_saveBtn{nullptr};
+            QPushButton* m_recordBtn{nullptr};
             QPushButton* m_clearBtn{nullptr};
 
             // Chart 1: poparcie
@@ -63,7 +142,29 @@ namespace app::ui
             QValueAxis*  m_sigX{nullptr};
             QValueAxis*  m_sigY{nullptr};
 
-            std::deque<StepStats>  m_samples;
-            std::vector<StepStats> m_allSamples;
+            // Statystyki per stan: tabela ostatniego kroku i udziały zaznaczonego stanu
+            struct RegionSeries
+            {
+                    RingBuffer<QPointF> a, b, n;
+            };
+
+            QStringList               m_regionCodes;
+            std::vector<RegionStats>  m_lastRegions;
+            std::vector<RegionSeries> m_regionSeries;
+            int                       m_selectedRegion{-1};
+
+            QTableWidget* m_regionTable{nullptr};
+            QChartView*   m_regionView{nullptr};
+            QLineSeries*  m_regionA{nullptr};
+            QLineSeries*  m_regionB{nullptr};
+            QLineSeries*  m_regionN{nullptr};
+            QValueAxis*   m_regionX{nullptr};
+            QValueAxis*   m_regionY{nullptr};
+
+            // Pełna historia przebiegu do eksportu CSV (kolumnowo, ze zrzutem na dysk)
+            StatsHistory m_history;
+
+            // Strumieniowy zapis kolejnych próbek do pliku (wątek w tle)
+            StatsExporter m_exporter;
     };
 } // namespace app::ui
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <vector>
+
+// Wielorozdzielczy magazyn szeregu czasowego dla wykresów.
+// Poziom 0 to surowe próbki, poziom k+1 wybiera jeden punkt z każdego kubełka
+// kBucketSize punktów poziomu k metodą LTTB (Largest-Triangle-Three-Buckets),
+// strumieniowo: kubełek jest rozstrzygany, gdy zapełni się następny.
+// Każdy poziom trzyma najwyżej `levelCapacity` ostatnich punktów, więc pamięć jest
+// ograniczona, a zapytanie o okno kosztuje O(punkty na ekranie), nie O(cała historia).
+class TimeSeriesStore
+{
+    public:
+        struct Point
+        {
+                double x = 0.0;
+                double y = 0.0;
+        };
+
+        static constexpr std::size_t kBucketSize = 4;
+        static constexpr std::size_t kMaxLevels  = 12;
+
+        explicit TimeSeriesStore(std::size_t levelCapacity = 16384);
+
+        void push(double x, double y);
+        void clear();
+
+        [[nodiscard]] bool   empty() const;
+        [[nodiscard]] double firstX() const; // najstarszy x, jaki da się jeszcze pokazać
+        [[nodiscard]] double lastX() const;
+
+        // Punkty z [xMin, xMax], zredukowane do co najwyżej targetPoints
+        [[nodiscard]] std::vector<Point>
+        query(double xMin, double xMax, std::size_t targetPoints) const;
+
+        [[nodiscard]] static std::vector<Point> lttb(const std::vector<Point>& data,
+                                                     std::size_t               threshold);
+
+    private:
+        struct Level
+        {
+                std::deque<Point>  points;
+                std::vector<Point> filling; // kubełek w trakcie zapełniania
+                std::vector<Point> pending; // pełny kubełek czekający na następny
+                Point              lastSelected{};
+                bool               hasSelected = false;
+                bool               trimmed     = false; // czy najstarsze punkty już wypadły
+        };
+
+        std::size_t        m_levelCapacity;
+        std::vector<Level> m_levels;
+
+        void pushToLevel(std::size_t level, const Point& p);
+        [[nodiscard]] std::size_t
+        chooseLevel(double xMin, double xMax, std::size_t targetPoints) const;
+};
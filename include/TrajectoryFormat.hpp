@@ -0,0 +1,87 @@
+#pragma once
+
+#include <QByteArray>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Format pliku trajektorii (.ptraj), kolejność bajtów hosta zapisana w nagłówku:
+//   FileHeader
+//   rekordy: RecordHeader + payload skompresowany qCompress
+//     DELTA    - zmienione komórki kroku: varint((odstęp indeksu << 2) | nowa strona),
+//                indeksy rosnąco, więc rozmiar zależy od liczby zmian, nie od siatki
+//     KEYFRAME - pełna płaszczyzna stron, 2 bity na komórkę
+//   stopka: IndexEntry[count], IndexFooter (dopisywana przy zamknięciu nagrania)
+namespace Trajectory
+{
+    inline constexpr char     kMagic[8]      = {'P', 'S', 'T', 'R', 'A', 'J', '\0', '\0'};
+    inline constexpr char     kIndexMagic[8] = {'P', 'S', 'T', 'R', 'I', 'D', 'X', '\0'};
+    inline constexpr uint32_t kVersion       = 1;
+    inline constexpr uint32_t kByteOrderMark = 0x01020304;
+
+    enum class RecordType : uint8_t
+    {
+        DELTA    = 0,
+        KEYFRAME = 1
+    };
+
+    struct FileHeader
+    {
+            char     magic[8];
+            uint32_t version;
+            uint32_t byteOrderMark;
+            int32_t  cols;
+            int32_t  rows;
+            uint32_t keyframeInterval;
+            uint32_t reserved;
+    };
+
+    struct RecordHeader
+    {
+            uint8_t  type;
+            uint8_t  reserved[3];
+            int32_t  iteration; // stan PO tym kroku
+            int32_t  countA;
+            int32_t  countB;
+            int32_t  countN;
+            uint32_t rawSize;
+            uint32_t payloadSize;
+            uint32_t reserved2;
+    };
+
+    struct IndexEntry
+    {
+            int32_t  iteration;
+            uint8_t  type;
+            uint8_t  reserved[3];
+            uint64_t offset; // początek RecordHeader
+    };
+
+    struct IndexFooter
+    {
+            uint64_t count;
+            uint64_t indexOffset;
+            char     magic[8];
+    };
+
+    static_assert(sizeof(FileHeader) == 32);
+    static_assert(sizeof(RecordHeader) == 32);
+    static_assert(sizeof(IndexEntry) == 16);
+    static_assert(sizeof(IndexFooter) == 24);
+
+    // Zmiana komórki w postaci zbieranej przez Simulation: (indeks << 2) | strona
+    [[nodiscard]] inline uint32_t changeIndex(uint32_t change)
+    {
+        return change >> 2;
+    }
+    [[nodiscard]] inline uint8_t changeSide(uint32_t change)
+    {
+        return static_cast<uint8_t>(change bitand 0x3u);
+    }
+
+    [[nodiscard]] QByteArray encodeDelta(const std::vector<uint32_t>& changes);
+    [[nodiscard]] bool       applyDelta(const QByteArray& raw, std::vector<uint8_t>& sides);
+
+    [[nodiscard]] QByteArray encodeKeyframe(const std::vector<uint8_t>& sides);
+    [[nodiscard]] bool       decodeKeyframe(const QByteArray& raw, std::vector<uint8_t>& sides);
+} // namespace Trajectory
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "TrajectoryFormat.hpp"
+
+#include <QFile>
+#include <QString>
+#include <cstddef>
+#include <vector>
+
+// Odczyt nagrania trajektorii do odtwarzania. Plik jest mapowany w pamięci; lista rekordów
+// pochodzi z indeksu na końcu pliku, a gdy go brak (przerwane nagranie) - z przejścia
+// po rekordach do pierwszego niepełnego. seek() dekoduje najbliższy keyframe i dokłada
+// delty, a przy przewijaniu do przodu kontynuuje od bieżącej pozycji.
+class TrajectoryReader
+{
+    public:
+        struct Record
+        {
+                int32_t                iteration{};
+                Trajectory::RecordType type{Trajectory::RecordType::DELTA};
+                int32_t                countA{};
+                int32_t                countB{};
+                int32_t                countN{};
+                uint64_t               offset{}; // początek payloadu
+                uint32_t               payloadSize{};
+                uint32_t               rawSize{};
+        };
+
+        TrajectoryReader() = default;
+
+        TrajectoryReader(const TrajectoryReader&)            = delete;
+        TrajectoryReader& operator=(const TrajectoryReader&) = delete;
+
+        bool open(const QString& path, QString* errorMessage = nullptr);
+        void close();
+
+        [[nodiscard]] bool isOpen() const;
+        [[nodiscard]] int  cols() const;
+        [[nodiscard]] int  rows() const;
+
+        [[nodiscard]] const std::vector<Record>& records() const;
+
+        // Stan po ostatnim rekordzie o iteracji <= iteration
+        bool seek(int iteration, QString* errorMessage = nullptr);
+
+        [[nodiscard]] int                         currentIteration() const;
+        [[nodiscard]] const std::vector<uint8_t>& sides() const;
+
+    private:
+        [[nodiscard]] bool readIndex();
+        void               scanRecords();
+        [[nodiscard]] bool readRecordAt(uint64_t headerOffset, Record& out) const;
+        [[nodiscard]] bool applyRecord(std::size_t index);
+
+        QFile        m_file;
+        QByteArray   m_fallback; // gdy mapowanie się nie uda
+        const uchar* m_data{nullptr};
+        uint64_t     m_size{0};
+
+        Trajectory::FileHeader   m_header{};
+        std::vector<Record>      m_records;
+        std::vector<std::size_t> m_keyframes; // indeksy rekordów KEYFRAME
+        std::vector<uint8_t>     m_sides;
+        std::ptrdiff_t           m_position{-1}; // ostatni zastosowany rekord
+};
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "TrajectoryFormat.hpp"
+
+#include <QFile>
+#include <QString>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class Simulation;
+
+// Nagrywanie trajektorii (format w TrajectoryFormat.hpp). Po każdym kroku GUI kopiuje
+// tylko listę zmienionych komórek (co keyframeInterval kroków pełną płaszczyznę stron),
+// a kodowanie, kompresja i zapis odbywają się w wątku w tle.
+class TrajectoryRecorder
+{
+    public:
+        TrajectoryRecorder() = default;
+        ~TrajectoryRecorder();
+
+        TrajectoryRecorder(const TrajectoryRecorder&)            = delete;
+        TrajectoryRecorder& operator=(const TrajectoryRecorder&) = delete;
+
+        // Pierwszy rekord to keyframe bieżącego stanu symulacji
+        bool start(const QString& path, Simulation& simulation, QString* errorMessage = nullptr);
+        void stop(); // zapisuje resztę kolejki i indeks
+        void record(const Simulation& simulation);
+
+        // Stan zmieniony poza krokiem (np. malowanie) - następny rekord będzie keyframe
+        void requestKeyframe();
+
+        [[nodiscard]] bool isRunning() const;
+        [[nodiscard]] bool hasFailed() const;
+
+    private:
+        struct Job
+        {
+                Trajectory::RecordType type = Trajectory::RecordType::DELTA;
+                int32_t                iteration{};
+                int32_t                countA{};
+                int32_t                countB{};
+                int32_t                countN{};
+                std::vector<uint32_t>  changes;
+                std::vector<uint8_t>   sides;
+        };
+
+        void enqueue(Job job);
+        void run();
+        void writeRecord(const Job& job);
+        void writeIndex();
+
+        QFile       m_file;
+        Simulation* m_simulation{nullptr};
+        bool        m_running{false}; // tylko wątek GUI
+        int         m_stepsSinceKeyframe{0};
+        bool        m_keyframeRequested{false};
+
+        std::thread                         m_thread;
+        std::mutex                          m_mutex;
+        std::condition_variable             m_wake;
+        std::deque<Job>                     m_pending;
+        bool                                m_stopRequested{false};
+        std::atomic<bool>                   m_failed{false};
+        std::vector<Trajectory::IndexEntry> m_index; // tylko wątek zapisu
+};
@@ -15,6 +15,34 @@ enum class NeighbourhoodType : uint8_t
 
 };
 
+enum class OverlayMode : uint8_t
+{
+    SIDE = 0,
+    HYSTERESIS,
+    THRESHOLD,
+    FIELD,          // ostatnie policzone h
+    TIME_SINCE_FLIP // iteracje od ostatniej zmiany strony
+};
+
+// Narzędzia malowania; kolejność odpowiada combo w MainWindow
+enum class PaintTool : uint8_t
+{
+    BRUSH = 0,
+    RECTANGLE,  // przeciągnięcie od rogu do rogu
+    POLYGON,    // kliknięcia dodają wierzchołki, dwuklik zamyka
+    STATE_FILL, // cały stan mapy pod kursorem
+    STATE_SEED  // losowy ułamek komórek stanu
+};
+
+// Generatory warunków początkowych; kolejność odpowiada combo presetów w MainWindow
+enum class SeedPattern : uint8_t
+{
+    UNIFORM = 0,
+    CLUSTERED,   // zwarte plamy wokół losowych środków
+    STATE_QUOTA, // po równo w każdym stanie mapy
+    GRADIENT     // A gęstsze na zachodzie, B na wschodzie
+};
+
 struct CellData
 {
         Side side   = Side::NONE;
@@ -23,5 +51,5 @@ struct CellData
         double threshold  = 0.5;
         double hysteresis = 0.0;
 
-        uint8_t stateId = 0;
+        uint8_t stateId = 255; // 255 = poza stanami mapy, jak UsMap::kNoState
 };
@@ -2,10 +2,11 @@
 
 #include "Types.hpp"
 
-#include <QHash>
 #include <QImage>
+#include <QCache>
 #include <QMap>
 #include <QPainter>
+#include <QPixmap>
 #include <QPointF>
 #include <QRectF>
 #include <QSize>
@@ -34,6 +35,9 @@ class UsMap
 
         UsMap(QString svgFilePath, int cols, int rows);
 
+        // Nowy rozmiar siatki unieważnia produkty; trzeba je zbudować ponownie
+        // (buildStateProducts), zwykle z cache dla tego rozmiaru
+        void               setGridSize(int cols, int rows);
         [[nodiscard]] bool buildStateProducts(QString* errorMessage = nullptr);
 
         [[nodiscard]] const Products& getProducts() const;
@@ -54,18 +58,34 @@ class UsMap
                 QRgb    fill = 0;
         };
 
-        std::vector<State>   m_states;
-        QMap<QString, int>   m_stateIdToIndex;
-        QHash<QRgb, uint8_t> m_colorToState;
+        // Kolor wypełnienia -> stan, posortowane po kolorze (wyszukiwanie binarne)
+        struct PaletteEntry
+        {
+                QRgb    color = 0;
+                uint8_t state = kNoState;
+        };
+
+        std::vector<State>        m_states;
+        QMap<QString, int>        m_stateIdToIndex;
+        std::vector<PaletteEntry> m_palette;
 
         QString              m_svgFilePath;
         mutable QSvgRenderer m_svgRenderer;
         mutable QSvgRenderer m_svgOutlineRenderer;
 
+        // Rasterized outlines for the last destination size; panning only blits it. At high
+        // zoom the whole map is too large, so tiles (key: tile column << 32 | row, in map
+        // coordinates) are rendered on demand for the same size and kept in an LRU cache.
+        mutable QPixmap                  m_outlineCache;
+        mutable QCache<quint64, QPixmap> m_outlineTiles;
+        mutable QSize                    m_outlineCacheSize;
+        mutable qreal                    m_outlineCacheDpr = 0.0;
+
         Products   m_outputProducts;
         QByteArray m_svgRawOriginal;
-        QByteArray m_svgRaw;
-        QImage     m_maskImage;
+        QByteArray m_svgHash; // SHA-1 treści SVG, klucz cache produktów
+        QByteArray m_svgRaw;        // bez konturów, do rasteryzacji stanów
+        QByteArray m_svgOutlineRaw; // bez wypełnień, do rysowania konturów
 
         bool             m_productsBuilt = false;
         bool             m_debugEnabled  = false;
@@ -74,10 +94,14 @@ class UsMap
 
         [[nodiscard]] bool loadAndParseSvg(QString* errorMessage);
         [[nodiscard]] bool readSvgFile(QString* errorMessage);
-        void               removeStatesOutlines();
         [[nodiscard]] bool loadSvgPatched(QString* errorMessage);
         [[nodiscard]] bool loadSvgIntoRenderer(QString* errorMessage);
         [[nodiscard]] bool loadSvgOutlineWithoutFill(QString* errorMessage);
+        void               invalidateOutlineCache() const;
+        void               rebuildOutlineCache(const QSize& size, qreal dpr) const;
+        void               drawOutlineTiles(QPainter& painter, const QRect& rect, qreal dpr) const;
+        [[nodiscard]] QPixmap renderOutlineTile(const QRect& tile, const QSize& mapSize,
+                                                qreal dpr) const;
         void               setError(QString* errorMessage, const QString& message) const;
 
         void                  resetStates();
@@ -86,17 +110,22 @@ class UsMap
         [[nodiscard]] QString extractFill(const QXmlStreamAttributes& attributes) const;
         void                  processStateElement(const QXmlStreamAttributes& attributes);
         void                  reportXmlError(const QXmlStreamReader& xml) const;
-        [[nodiscard]] bool    scanStatesFromSvg();
+        [[nodiscard]] bool    rewriteSvg(QString* errorMessage);
+        [[nodiscard]] bool    rewriteSvgOutline(QString* errorMessage);
 
-        void                 buildMaskAndActiveStates(int cols, int rows);
-        [[nodiscard]] QImage renderColorImage(int cols, int rows) const;
-        void                 buildColorToStateMap();
-        void                 initProductsBuffers();
-        void    assignStatesFromColorImage(const QImage& colorImage, int cols, int rows);
+        void    buildColorToStateMap();
+        void    rasterizeProducts(int cols, int rows);
+        void    debugSaveProducts(int cols, int rows) const;
         QString rgbToHex(QRgb c) const;
 
         void debugSave(const QString& name, const QImage& img) const;
 
+        // Cache produktów na dysku (UsMapCache.cpp)
+        void                  hashSvg();
+        [[nodiscard]] QString productsCachePath() const;
+        [[nodiscard]] bool    loadProductsCache();
+        void                  saveProductsCache() const;
+
         [[nodiscard]] static bool                isValidHexColor(const QString& hex);
         [[nodiscard]] static std::optional<QRgb> parseHexColor(const QString& hex);
 };
@@ -0,0 +1,150 @@
+#include "CellImagePyramid.hpp"
+
+#include <QRect>
+#include <algorithm>
+#include <cmath>
+
+using namespace app::ui;
+
+namespace
+{
+    int tilesFor(int pixels)
+    {
+        return (pixels + CellImagePyramid::kTileSize - 1) / CellImagePyramid::kTileSize;
+    }
+} // namespace
+
+void CellImagePyramid::reset(const QSize& baseSize)
+{
+    m_levels.clear();
+
+    QSize size = baseSize;
+    for (int level = 0; level < kMaxLevels and not size.isEmpty(); ++level)
+    {
+        Level l;
+        if (level > 0)
+        {
+            l.image = QImage(size, QImage::Format_ARGB32_Premultiplied);
+            l.image.fill(Qt::transparent);
+        }
+        l.tilesX = tilesFor(size.width());
+        l.tilesY = tilesFor(size.height());
+        l.dirty.assign(static_cast<std::size_t>(l.tilesX) * static_cast<std::size_t>(l.tilesY), 1);
+        m_levels.push_back(std::move(l));
+
+        if (size.width() <= 1 and size.height() <= 1)
+        {
+            break;
+        }
+        size = QSize((size.width() + 1) / 2, (size.height() + 1) / 2);
+    }
+
+    m_hasDirty = true;
+}
+
+void CellImagePyramid::update(const QImage& base)
+{
+    if (not m_hasDirty or m_levels.empty())
+    {
+        return;
+    }
+
+    constexpr int kHalfTile = kTileSize / 2;
+
+    for (std::size_t level = 1; level < m_levels.size(); ++level)
+    {
+        Level&        prev = m_levels[level - 1];
+        Level&        cur  = m_levels[level];
+        const QImage& src  = (level == 1) ? base : prev.image;
+        const QRect   bounds(QPoint(0, 0), cur.image.size());
+
+        for (int ty = 0; ty < prev.tilesY; ++ty)
+        {
+            for (int tx = 0; tx < prev.tilesX; ++tx)
+            {
+                const std::size_t t = static_cast<std::size_t>(ty) *
+                                          static_cast<std::size_t>(prev.tilesX) +
+                                      static_cast<std::size_t>(tx);
+                if (not prev.dirty[t])
+                {
+                    continue;
+                }
+                prev.dirty[t] = 0;
+
+                // Kafelek 32x32 poziomu k-1 to obszar 16x16 na poziomie k
+                const QRect dstRect =
+                    QRect(tx * kHalfTile, ty * kHalfTile, kHalfTile, kHalfTile).intersected(bounds);
+                downsampleRegion(src, cur.image, dstRect);
+
+                cur.dirty[static_cast<std::size_t>(ty >> 1) * static_cast<std::size_t>(cur.tilesX) +
+                          static_cast<std::size_t>(tx >> 1)] = 1;
+            }
+        }
+    }
+
+    std::fill(m_levels.back().dirty.begin(), m_levels.back().dirty.end(), 0);
+    m_hasDirty = false;
+}
+
+void CellImagePyramid::downsampleRegion(const QImage& src, QImage& dst, const QRect& dstRect)
+{
+    const int srcW = src.width();
+    const int srcH = src.height();
+
+    for (int y = dstRect.top(); y <= dstRect.bottom(); ++y)
+    {
+        const int sy0 = 2 * y;
+        const int sy1 = std::min(sy0 + 1, srcH - 1);
+
+        const QRgb* row0 = reinterpret_cast<const QRgb*>(src.constScanLine(sy0));
+        const QRgb* row1 = reinterpret_cast<const QRgb*>(src.constScanLine(sy1));
+        QRgb*       out  = reinterpret_cast<QRgb*>(dst.scanLine(y));
+
+        for (int x = dstRect.left(); x <= dstRect.right(); ++x)
+        {
+            const int sx0 = 2 * x;
+            const int sx1 = std::min(sx0 + 1, srcW - 1);
+
+            const QRgb p[4] = {row0[sx0], row0[sx1], row1[sx0], row1[sx1]};
+
+            // Średnia kanałów premultiplied = proporcja A/B/NONE w bloku 2x2
+            uint32_t a = 0, r = 0, g = 0, b = 0;
+            for (const QRgb px : p)
+            {
+                a += qAlpha(px);
+                r += qRed(px);
+                g += qGreen(px);
+                b += qBlue(px);
+            }
+            out[x] = qRgba(static_cast<int>((r + 2) / 4), static_cast<int>((g + 2) / 4),
+                           static_cast<int>((b + 2) / 4), static_cast<int>((a + 2) / 4));
+        }
+    }
+}
+
+int CellImagePyramid::levelCount() const
+{
+    return static_cast<int>(m_levels.size());
+}
+
+const QImage& CellImagePyramid::levelImage(int level, const QImage& base) const
+{
+    if (level <= 0 or level >= levelCount())
+    {
+        return base;
+    }
+    return m_levels[static_cast<std::size_t>(level)].image;
+}
+
+int CellImagePyramid::levelForScale(qreal devicePixelsPerCell) const
+{
+    if (devicePixelsPerCell >= 1.0 or devicePixelsPerCell <= 0.0 or m_levels.empty())
+    {
+        return 0;
+    }
+
+    // Najbliższy poziom nie grubszy od ekranu: piksel poziomu ma od 1/2 do 1 piksela
+    // urządzenia, więc skalowanie w dół jest mniejsze niż 2x i nie gubi komórek
+    const int level = static_cast<int>(std::floor(std::log2(1.0 / devicePixelsPerCell)));
+    return std::clamp(level, 0, levelCount() - 1);
+}
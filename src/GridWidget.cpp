@@ -9,6 +9,7 @@
 #include <QObject>
 #include <QPainter>
 #include <QPoint>
+#include <QPolygonF>
 #include <QStringLiteral>
 #include <QStringView>
 #include <QTimer>
@@ -18,12 +19,73 @@
 #include <Qt>
 #include <QtGlobal>
 #include <algorithm>
+#include <array>
 #include <cmath>
 #include <cstdint>
 #include <qnamespace.h>
 
 using namespace app::ui;
 
+namespace
+{
+    using ColorLut = std::array<QRgb, 256>;
+
+    struct LutStop
+    {
+            float pos;
+            QRgb  color;
+    };
+
+    ColorLut makeLut(std::initializer_list<LutStop> stops)
+    {
+        ColorLut lut{};
+        auto     it = stops.begin();
+        for (int i = 0; i < 256; ++i)
+        {
+            const float t = static_cast<float>(i) / 255.0f;
+            while (std::next(it) not_eq stops.end() and std::next(it)->pos < t)
+            {
+                ++it;
+            }
+            const LutStop& a = *it;
+            const LutStop& b = (std::next(it) not_eq stops.end()) ? *std::next(it) : *it;
+            const float    span = b.pos - a.pos;
+            const float    f    = (span > 0.0f) ? std::clamp((t - a.pos) / span, 0.0f, 1.0f) : 0.0f;
+
+            auto mix = [f](int ca, int cb)
+            {
+                const float v = static_cast<float>(ca) + f * static_cast<float>(cb - ca);
+                return static_cast<int>(std::lround(v));
+            };
+
+            lut[static_cast<std::size_t>(i)] =
+                qRgb(mix(qRed(a.color), qRed(b.color)), mix(qGreen(a.color), qGreen(b.color)),
+                     mix(qBlue(a.color), qBlue(b.color)));
+        }
+        return lut;
+    }
+
+    // Sekwencyjna (w przybliżeniu viridis) dla wartości nieujemnych
+    const ColorLut& sequentialLut()
+    {
+        static const ColorLut lut = makeLut({{0.00f, qRgb(68, 1, 84)},
+                                             {0.25f, qRgb(59, 82, 139)},
+                                             {0.50f, qRgb(33, 145, 140)},
+                                             {0.75f, qRgb(94, 201, 98)},
+                                             {1.00f, qRgb(253, 231, 37)}});
+        return lut;
+    }
+
+    // Rozbieżna dla pola h: B (niebieski) <- 0 (biały) -> A (czerwony)
+    const ColorLut& divergingLut()
+    {
+        static const ColorLut lut = makeLut({{0.0f, qRgb(33, 102, 172)},
+                                             {0.5f, qRgb(247, 247, 247)},
+                                             {1.0f, qRgb(178, 24, 43)}});
+        return lut;
+    }
+} // namespace
+
 GridWidget::GridWidget(QWidget* parent) : QWidget{parent}
 {
 }
@@ -64,6 +126,50 @@ void GridWidget::setPaintMode(bool on) noexcept
 {
     this->m_paintMode = on;
     setCursor(m_paintMode ? Qt::CrossCursor : Qt::ArrowCursor);
+    cancelShape();
+}
+
+void GridWidget::setPaintTool(PaintTool tool) noexcept
+{
+    m_paintTool = tool;
+    cancelShape();
+}
+
+void GridWidget::cancelShape() noexcept
+{
+    m_lastBrushCell = QPoint{-1, -1};
+    m_rectActive    = false;
+    m_polygon.clear();
+    update();
+}
+
+void GridWidget::invalidateCells(const QRect& cells)
+{
+    if (cells.isEmpty() or not canPaint())
+    {
+        return;
+    }
+
+    const QRectF destRectF = mapDestRect();
+    if (not destRectF.isValid())
+    {
+        return;
+    }
+
+    // Margines na zaokrąglenia krawędzi komórek przy dowolnym zoomie
+    update(cellsWidgetRect(destRectF, cells).toAlignedRect().adjusted(-1, -1, 1, 1));
+}
+
+void GridWidget::setOverlayMode(OverlayMode mode) noexcept
+{
+    m_overlayMode = mode;
+    update();
+}
+
+void GridWidget::setSideOverride(const std::vector<uint8_t>* sides) noexcept
+{
+    m_sideOverride = sides;
+    update();
 }
 
 void GridWidget::clearMap() noexcept
@@ -99,9 +205,9 @@ QColor GridWidget::getColorFor(CellData cell) const noexcept
     }
 }
 
-void GridWidget::drawGrid(QPainter& painter) const
+void GridWidget::drawGrid(QPainter& painter, const QRect& visibleCells) const
 {
-    if (not m_usMap or not m_showGrid)
+    if (not m_usMap or not m_showGrid or visibleCells.isEmpty())
     {
         return;
     }
@@ -114,8 +220,10 @@ void GridWidget::drawGrid(QPainter& painter) const
 
     const Geometry g = computeGeometry(m_zoom);
 
-    const float originX = g.originXCenter + static_cast<float>(m_pan.x());
-    const float originY = g.originYCenter + static_cast<float>(m_pan.y());
+    const qreal originX = static_cast<qreal>(g.originXCenter) + m_pan.x();
+    const qreal originY = static_cast<qreal>(g.originYCenter) + m_pan.y();
+    const qreal cellW   = static_cast<qreal>(g.cellWidth);
+    const qreal cellH   = static_cast<qreal>(g.cellHeight);
 
     QPen pen(Qt::white);
     pen.setColor(QColor(255, 255, 255, Config::GridWidget::gridAlpha));
@@ -123,21 +231,26 @@ void GridWidget::drawGrid(QPainter& painter) const
     pen.setCosmetic(true);
     painter.setPen(pen);
 
-    for (int x = 1; x < products.cols; ++x)
+    // Linie tylko dla widocznych kolumn/wierszy i tylko na widocznym odcinku
+    const qreal top    = originY + static_cast<qreal>(visibleCells.top()) * cellH;
+    const qreal bottom = originY + static_cast<qreal>(visibleCells.bottom() + 1) * cellH;
+    const qreal left   = originX + static_cast<qreal>(visibleCells.left()) * cellW;
+    const qreal right  = originX + static_cast<qreal>(visibleCells.right() + 1) * cellW;
+
+    const int firstCol = std::max(1, visibleCells.left());
+    const int lastCol  = std::min(products.cols - 1, visibleCells.right() + 1);
+    for (int x = firstCol; x <= lastCol; ++x)
     {
-        const qreal xpos =
-            static_cast<qreal>(originX) + static_cast<qreal>(x) * static_cast<qreal>(g.cellWidth);
-        painter.drawLine(
-            QPointF{xpos, static_cast<qreal>(originY)},
-            QPointF{xpos, static_cast<qreal>(originY) + static_cast<qreal>(g.mapHeight)});
+        const qreal xpos = originX + static_cast<qreal>(x) * cellW;
+        painter.drawLine(QPointF{xpos, top}, QPointF{xpos, bottom});
     }
-    for (int y = 1; y < products.rows; ++y)
+
+    const int firstRow = std::max(1, visibleCells.top());
+    const int lastRow  = std::min(products.rows - 1, visibleCells.bottom() + 1);
+    for (int y = firstRow; y <= lastRow; ++y)
     {
-        const qreal ypos =
-            static_cast<qreal>(originY) + static_cast<qreal>(y) * static_cast<qreal>(g.cellHeight);
-        painter.drawLine(
-            QPointF{static_cast<qreal>(originX), ypos},
-            QPointF{static_cast<qreal>(originX) + static_cast<qreal>(g.mapWidth), ypos});
+        const qreal ypos = originY + static_cast<qreal>(y) * cellH;
+        painter.drawLine(QPointF{left, ypos}, QPointF{right, ypos});
     }
 }
 
@@ -146,16 +259,50 @@ bool GridWidget::canPaint() const noexcept
     return m_usMap and m_sim;
 }
 
-void GridWidget::drawCells(QPainter& painter, const QRectF& destRectF) const
+void GridWidget::drawCells(QPainter&     painter,
+                           const QRectF& destRectF,
+                           const QRect&  visibleCells) const
 {
-    const auto& products = m_usMap->getProducts();
-    const QRect destRect = destRectF.toAlignedRect();
-    painter.drawImage(destRect, m_cellsImage, QRectF(0, 0, products.cols, products.rows));
+    if (visibleCells.isEmpty())
+    {
+        return;
+    }
+
+    const auto&  products = m_usMap->getProducts();
+    const qreal  cellW    = destRectF.width() / static_cast<qreal>(products.cols);
+    const qreal  cellH    = destRectF.height() / static_cast<qreal>(products.rows);
+    const QRectF target(destRectF.left() + static_cast<qreal>(visibleCells.left()) * cellW,
+                        destRectF.top() + static_cast<qreal>(visibleCells.top()) * cellH,
+                        static_cast<qreal>(visibleCells.width()) * cellW,
+                        static_cast<qreal>(visibleCells.height()) * cellH);
+
+    // Przy oddaleniu rysujemy z poziomu piramidy zamiast skalować pełny obraz
+    const qreal devicePixelsPerCell = std::min(cellW, cellH) * devicePixelRatioF();
+    const int   level               = m_cellsPyramid.levelForScale(devicePixelsPerCell);
+    if (level == 0)
+    {
+        painter.drawImage(target, m_cellsImage, QRectF(visibleCells));
+        return;
+    }
+
+    m_cellsPyramid.update(m_cellsImage);
+
+    const qreal  scale = 1.0 / static_cast<qreal>(1 << level);
+    const QRectF source(QRectF(visibleCells).topLeft() * scale,
+                        QRectF(visibleCells).size() * scale);
+
+    painter.save();
+    painter.setRenderHint(QPainter::SmoothPixmapTransform, true);
+    painter.drawImage(target, m_cellsPyramid.levelImage(level, m_cellsImage), source);
+    painter.restore();
 }
 
 void GridWidget::drawOutlines(QPainter& painter, const QRectF& destRectF) const
 {
-    m_usMap->drawStateOutlines(painter, destRectF.toAlignedRect());
+    // Rozmiar zależy tylko od zoomu, więc przesuwanie nie unieważnia cache konturów
+    const QRect destRect(destRectF.topLeft().toPoint(),
+                         QSize(qRound(destRectF.width()), qRound(destRectF.height())));
+    m_usMap->drawStateOutlines(painter, destRect);
 }
 
 void GridWidget::drawOuterFrame(QPainter& painter) const
@@ -173,6 +320,51 @@ void GridWidget::drawOuterFrame(QPainter& painter) const
     painter.drawRect(frameRect);
 }
 
+void GridWidget::beginPaintAt(const QPointF& pos, Qt::MouseButton button)
+{
+    const QPoint cell = productPointFromWidgetPos(pos);
+    if (cell.x() < 0 or cell.y() < 0)
+    {
+        return;
+    }
+
+    if (button not_eq Qt::LeftButton and button not_eq Qt::RightButton)
+    {
+        return;
+    }
+    const Side side = (button == Qt::LeftButton) ? Side::A : Side::B;
+
+    switch (m_paintTool)
+    {
+    case PaintTool::BRUSH:
+        m_lastBrushCell = cell;
+        emit paintBrushRequested(cell, cell, side);
+        break;
+    case PaintTool::RECTANGLE:
+        m_rectActive = true;
+        m_rectAnchor = cell;
+        m_rectCursor = cell;
+        m_shapeSide  = side;
+        update();
+        break;
+    case PaintTool::POLYGON:
+        m_polygon.append(cell);
+        m_shapeSide = side;
+        update();
+        break;
+    case PaintTool::STATE_FILL:
+    case PaintTool::STATE_SEED:
+    {
+        const uint8_t stateId = stateAtWidgetPos(pos);
+        if (stateId not_eq UsMap::kNoState)
+        {
+            emit paintStateRequested(stateId, side);
+        }
+        break;
+    }
+    }
+}
+
 void GridWidget::applyBrushAt(const QPointF& pos, Qt::MouseButtons buttons)
 {
     if (not m_usMap)
@@ -186,28 +378,63 @@ void GridWidget::applyBrushAt(const QPointF& pos, Qt::MouseButtons buttons)
         return;
     }
 
-    int stateId = -1;
-    if (m_mapMode)
+    if (m_mapMode and stateAtWidgetPos(pos) == UsMap::kNoState)
     {
-        const uint8_t sid = stateAtWidgetPos(pos);
-        if (sid == UsMap::kNoState)
+        m_lastBrushCell = QPoint{-1, -1}; // poza mapą pędzel się odrywa
+        return;
+    }
+
+    if (m_paintTool == PaintTool::RECTANGLE and m_rectActive)
+    {
+        if (cell not_eq m_rectCursor)
         {
-            return;
+            m_rectCursor = cell;
+            update();
         }
-        stateId = sid;
+        return;
     }
-
-    if (buttons bitand Qt::LeftButton)
+    if (m_paintTool not_eq PaintTool::BRUSH)
     {
-        emit paintCellRequested(cell.x(), cell.y(), Side::A);
+        return;
     }
 
-    if (buttons bitand Qt::RightButton)
+    // Odcinek od poprzedniej pozycji, żeby szybki ruch myszy nie zostawiał przerw
+    const Side   side = (buttons bitand Qt::LeftButton) ? Side::A : Side::B;
+    const QPoint from = (m_lastBrushCell.x() < 0) ? cell : m_lastBrushCell;
+    m_lastBrushCell   = cell;
+    emit paintBrushRequested(from, cell, side);
+}
+
+void GridWidget::drawPaintPreview(QPainter& painter, const QRectF& destRectF) const
+{
+    if (not m_rectActive and m_polygon.isEmpty())
     {
-        emit paintCellRequested(cell.x(), cell.y(), Side::B);
+        return;
     }
 
-    update();
+    QPen pen(getColorFor(CellData{.side = m_shapeSide}));
+    pen.setCosmetic(true);
+    pen.setStyle(Qt::DashLine);
+    painter.save();
+    painter.setPen(pen);
+    painter.setBrush(Qt::NoBrush);
+
+    if (m_rectActive)
+    {
+        const QRect cells = QRect(m_rectAnchor, m_rectCursor).normalized();
+        painter.drawRect(cellsWidgetRect(destRectF, cells));
+    }
+    else
+    {
+        // Łamana przez środki komórek wierzchołków
+        QPolygonF outline;
+        for (const QPoint& vertex : m_polygon)
+        {
+            outline.append(cellsWidgetRect(destRectF, QRect(vertex, vertex)).center());
+        }
+        painter.drawPolyline(outline);
+    }
+    painter.restore();
 }
 
 void GridWidget::updateCellInfoAt(const QPointF& position)
@@ -225,7 +452,12 @@ void GridWidget::updateCellInfoAt(const QPointF& position)
         return;
     }
 
-    const auto cellData = m_sim->cellAt(cell.x(), cell.y());
+    auto cellData = m_sim->cellAt(cell.x(), cell.y());
+    if (m_sideOverride)
+    {
+        cellData.side = static_cast<Side>((*m_sideOverride)[static_cast<std::size_t>(
+            cell.y() * m_sim->getCols() + cell.x())]);
+    }
 
     QString stateStr;
     switch (cellData.side)
@@ -315,7 +547,44 @@ QRectF GridWidget::mapDestRect() const
                   static_cast<qreal>(g.mapWidth), static_cast<qreal>(g.mapHeight));
 }
 
-void GridWidget::rebuildCellsImageIfNeeded() const
+QRect GridWidget::visibleCellRect(const QRectF& destRectF, const QRectF& area) const
+{
+    const auto& products = m_usMap->getProducts();
+    const QRectF visible = destRectF.intersected(area);
+    if (visible.isEmpty())
+    {
+        return {};
+    }
+
+    const qreal cellW = destRectF.width() / static_cast<qreal>(products.cols);
+    const qreal cellH = destRectF.height() / static_cast<qreal>(products.rows);
+
+    const qreal fromLeft   = (visible.left() - destRectF.left()) / cellW;
+    const qreal fromTop    = (visible.top() - destRectF.top()) / cellH;
+    const qreal fromRight  = (visible.right() - destRectF.left()) / cellW;
+    const qreal fromBottom = (visible.bottom() - destRectF.top()) / cellH;
+
+    const int x0 = std::clamp(static_cast<int>(std::floor(fromLeft)), 0, products.cols);
+    const int y0 = std::clamp(static_cast<int>(std::floor(fromTop)), 0, products.rows);
+    const int x1 = std::clamp(static_cast<int>(std::ceil(fromRight)), 0, products.cols);
+    const int y1 = std::clamp(static_cast<int>(std::ceil(fromBottom)), 0, products.rows);
+
+    return QRect(QPoint(x0, y0), QPoint(x1 - 1, y1 - 1));
+}
+
+QRectF GridWidget::cellsWidgetRect(const QRectF& destRectF, const QRect& cells) const
+{
+    const auto& products = m_usMap->getProducts();
+    const qreal cellW    = destRectF.width() / static_cast<qreal>(products.cols);
+    const qreal cellH    = destRectF.height() / static_cast<qreal>(products.rows);
+
+    return QRectF(destRectF.left() + static_cast<qreal>(cells.left()) * cellW,
+                  destRectF.top() + static_cast<qreal>(cells.top()) * cellH,
+                  static_cast<qreal>(cells.width()) * cellW,
+                  static_cast<qreal>(cells.height()) * cellH);
+}
+
+void GridWidget::rebuildCellsImageIfNeeded(const QRect& visibleCells) const
 {
     if (not m_usMap or not m_sim)
     {
@@ -332,36 +601,196 @@ void GridWidget::rebuildCellsImageIfNeeded() const
     if (m_cellsImage.size() not_eq imgSize)
     {
         m_cellsImage = QImage(imgSize, QImage::Format_ARGB32_Premultiplied);
+        m_cellsImage.fill(Qt::transparent);
+        m_cellsPyramid.reset(imgSize);
+    }
+
+    if (visibleCells.isEmpty())
+    {
+        return;
     }
 
-    m_cellsImage.fill(Qt::transparent);
     const bool useMask = m_mapMode;
 
-    for (int y = 0; y < products.rows; ++y)
+    const QRgb colorA    = getColorFor(CellData{.side = Side::A}).rgba();
+    const QRgb colorB    = getColorFor(CellData{.side = Side::B}).rgba();
+    const QRgb colorNone = getColorFor(CellData{.side = Side::NONE}).rgba();
+
+    // Rasteryzujemy tylko widoczny fragment, wiersz po wierszu prosto do scanline.
+    // Zmienione piksele oznaczają kafelki piramidy do przebudowy.
+    for (int y = visibleCells.top(); y <= visibleCells.bottom(); ++y)
     {
-        for (int x = 0; x < products.cols; ++x)
+        QRgb* line = reinterpret_cast<QRgb*>(m_cellsImage.scanLine(y));
+
+        auto put = [&](int x, QRgb value)
         {
-            const int index = y * products.cols + x;
-            if (useMask and not products.activeStates[static_cast<std::size_t>(index)])
+            if (line[x] not_eq value)
             {
-                continue;
+                line[x] = value;
+                m_cellsPyramid.markDirty(x, y);
             }
+        };
 
-            QColor color = getColorFor(m_sim->cellAt(x, y));
+        // Nagranie zawiera tylko strony, więc przy odtwarzaniu nakładki są wyłączone
+        const bool overlay = (m_overlayMode not_eq OverlayMode::SIDE) and not m_sideOverride;
+        if (overlay)
+        {
+            fillOverlayRow(y, visibleCells.left(), visibleCells.right());
+        }
+        else if (not m_sideOverride)
+        {
+            fillSideRow(y, visibleCells.left(), visibleCells.right());
+        }
+        const ColorLut& lut =
+            (m_overlayMode == OverlayMode::FIELD) ? divergingLut() : sequentialLut();
 
-            const int    stateId = products.stateIds[static_cast<std::size_t>(index)];
-            const QPoint cellPoint{x, y};
+        for (int x = visibleCells.left(); x <= visibleCells.right(); ++x)
+        {
+            const std::size_t index = static_cast<std::size_t>(y) *
+                                          static_cast<std::size_t>(products.cols) +
+                                      static_cast<std::size_t>(x);
+            if (useMask and not products.activeStates[index])
+            {
+                put(x, 0); // transparent
+                continue;
+            }
 
+            const int stateId = products.stateIds[index];
             if (useMask and m_coloredStates.contains(stateId))
             {
-                color = m_coloredStates.value(stateId);
+                put(x, qPremultiply(m_coloredStates.value(stateId).rgba()));
+                continue;
+            }
+
+            if (overlay)
+            {
+                const float v = m_rowValues[static_cast<std::size_t>(x - visibleCells.left())];
+                put(x, lut[static_cast<std::size_t>(v * 255.0f + 0.5f)]);
+                continue;
             }
 
-            m_cellsImage.setPixelColor(x, y, color);
+            const Side side =
+                m_sideOverride ? static_cast<Side>((*m_sideOverride)[index])
+                               : m_rowSides[static_cast<std::size_t>(x - visibleCells.left())];
+            switch (side)
+            {
+            case Side::A:
+                put(x, colorA);
+                break;
+            case Side::B:
+                put(x, colorB);
+                break;
+            default:
+                put(x, colorNone);
+                break;
+            }
         }
     }
 }
 
+void GridWidget::fillSideRow(int y, int x0, int x1) const
+{
+    // Komórki poza maską zostają NONE; w trybie mapy i tak są przezroczyste
+    m_rowSides.assign(static_cast<std::size_t>(x1 - x0 + 1), Side::NONE);
+
+    const GridView  view  = m_sim->view();
+    const CellData* cells = view.cells().data();
+    view.forEachRun(y, x0, x1,
+                    [&](int x, std::size_t dense, std::size_t count)
+                    {
+                        const auto pos = static_cast<std::size_t>(x - x0);
+                        for (std::size_t k = 0; k < count; ++k)
+                        {
+                            m_rowSides[pos + k] = cells[dense + k].side;
+                        }
+                    });
+}
+
+void GridWidget::fillOverlayRow(int y, int x0, int x1) const
+{
+    // Wartości znormalizowane do [0, 1]; osobna ciasna pętla na tryb, potem LUT w scanline.
+    // Stan jest indeksowany gęsto, więc czytamy odcinkami aktywnych komórek wiersza.
+    m_rowValues.assign(static_cast<std::size_t>(x1 - x0 + 1), 0.0f);
+
+    const GridView  view  = m_sim->view();
+    const CellData* cells = view.cells().data();
+
+    switch (m_overlayMode)
+    {
+    case OverlayMode::HYSTERESIS:
+    {
+        const float inv = 1.0f / std::max(1e-6f, m_sim->getParameters().hysMaxTotal);
+        view.forEachRun(y, x0, x1,
+                        [&](int x, std::size_t dense, std::size_t count)
+                        {
+                            const auto pos = static_cast<std::size_t>(x - x0);
+                            for (std::size_t k = 0; k < count; ++k)
+                            {
+                                const float h = static_cast<float>(cells[dense + k].hysteresis);
+                                m_rowValues[pos + k] = std::clamp(h * inv, 0.0f, 1.0f);
+                            }
+                        });
+        break;
+    }
+    case OverlayMode::THRESHOLD:
+    {
+        const float inv = static_cast<float>(1.0 / Config::GridWidget::overlayThresholdMax);
+        view.forEachRun(y, x0, x1,
+                        [&](int x, std::size_t dense, std::size_t count)
+                        {
+                            const auto pos = static_cast<std::size_t>(x - x0);
+                            for (std::size_t k = 0; k < count; ++k)
+                            {
+                                const float t = static_cast<float>(cells[dense + k].threshold);
+                                m_rowValues[pos + k] = std::clamp(t * inv, 0.0f, 1.0f);
+                            }
+                        });
+        break;
+    }
+    case OverlayMode::FIELD:
+    {
+        const auto field = view.field();
+        if (field.empty())
+        {
+            std::fill(m_rowValues.begin(), m_rowValues.end(), 0.5f);
+            break;
+        }
+        const float  inv = static_cast<float>(0.5 / Config::GridWidget::overlayFieldRange);
+        const float* src = field.data();
+        view.forEachRun(y, x0, x1,
+                        [&](int x, std::size_t dense, std::size_t count)
+                        {
+                            const auto pos = static_cast<std::size_t>(x - x0);
+                            for (std::size_t k = 0; k < count; ++k)
+                            {
+                                const float v        = 0.5f + src[dense + k] * inv;
+                                m_rowValues[pos + k] = std::clamp(v, 0.0f, 1.0f);
+                            }
+                        });
+        break;
+    }
+    case OverlayMode::TIME_SINCE_FLIP:
+    {
+        const int   now = m_sim->getIteration();
+        const int*  src = view.lastFlipIterations().data();
+        const float inv = 1.0f / static_cast<float>(Config::GridWidget::overlayFlipAgeMax);
+        view.forEachRun(y, x0, x1,
+                        [&](int x, std::size_t dense, std::size_t count)
+                        {
+                            const auto pos = static_cast<std::size_t>(x - x0);
+                            for (std::size_t k = 0; k < count; ++k)
+                            {
+                                const float age      = static_cast<float>(now - src[dense + k]);
+                                m_rowValues[pos + k] = std::clamp(age * inv, 0.0f, 1.0f);
+                            }
+                        });
+        break;
+    }
+    default:
+        break;
+    }
+}
+
 QPoint GridWidget::productPointFromWidgetPos(QPointF pos) const
 {
     if (not m_usMap)
@@ -467,7 +896,7 @@ void GridWidget::updatePanForZoom(const QPointF& cursorPos, qreal newZoom)
                mapY * static_cast<qreal>(after.cellHeight));
 }
 
-void GridWidget::paintEvent(QPaintEvent*)
+void GridWidget::paintEvent(QPaintEvent* event)
 {
     QPainter painter(this);
     painter.fillRect(rect(), Config::GridWidget::backgroundColor);
@@ -483,12 +912,18 @@ void GridWidget::paintEvent(QPaintEvent*)
         return;
     }
 
-    rebuildCellsImageIfNeeded();
+    // Częściowy repaint (invalidateCells) rasteryzuje tylko komórki pod odświeżanym
+    // obszarem; resztę obrazu komórek i tak przycina painter
+    const QRect visibleCells = visibleCellRect(destRectF, QRectF(rect()));
+    const QRect rasterCells  = (event->rect() == rect())
+                                   ? visibleCells
+                                   : visibleCellRect(destRectF, QRectF(event->rect()));
+    rebuildCellsImageIfNeeded(rasterCells);
 
     painter.setRenderHint(QPainter::Antialiasing, false);
     painter.setRenderHint(QPainter::SmoothPixmapTransform, false);
 
-    drawCells(painter, destRectF);
+    drawCells(painter, destRectF, visibleCells);
 
     if (m_mapMode)
     {
@@ -497,9 +932,10 @@ void GridWidget::paintEvent(QPaintEvent*)
 
     if (m_showGrid)
     {
-        drawGrid(painter);
+        drawGrid(painter, visibleCells);
     }
 
+    drawPaintPreview(painter, destRectF);
     drawOuterFrame(painter);
 }
 
@@ -539,16 +975,7 @@ void GridWidget::mousePressEvent(QMouseEvent* event)
             return event->accept();
         }
 
-        if (event->button() == Qt::LeftButton)
-        {
-            emit paintCellRequested(cell.x(), cell.y(), Side::A);
-        }
-        else if (event->button() == Qt::RightButton)
-        {
-            emit paintCellRequested(cell.x(), cell.y(), Side::B);
-        }
-
-        update();
+        beginPaintAt(event->position(), event->button());
         return event->accept();
     }
 
@@ -558,14 +985,7 @@ void GridWidget::mousePressEvent(QMouseEvent* event)
 
     int stateId = static_cast<int>(sid);
 
-    if (event->button() == Qt::LeftButton)
-    {
-        emit paintCellRequested(cell.x(), cell.y(), Side::A);
-    }
-    else if (event->button() == Qt::RightButton)
-    {
-        emit paintCellRequested(cell.x(), cell.y(), Side::B);
-    }
+    beginPaintAt(event->position(), event->button());
 
     m_selectedSingleStateId = stateId;
 
@@ -690,5 +1110,29 @@ void GridWidget::mouseReleaseEvent(QMouseEvent* event)
         return event->accept();
     }
 
+    m_lastBrushCell = QPoint{-1, -1};
+    if (m_rectActive)
+    {
+        m_rectActive = false;
+        emit paintRectRequested(QRect(m_rectAnchor, m_rectCursor).normalized(), m_shapeSide);
+        update();
+        return event->accept();
+    }
+
     QWidget::mouseReleaseEvent(event);
 }
+
+void GridWidget::mouseDoubleClickEvent(QMouseEvent* event)
+{
+    // Dwuklik zamyka wielokąt; pierwsze kliknięcie dodało już ostatni wierzchołek
+    if (m_paintTool == PaintTool::POLYGON and not m_polygon.isEmpty())
+    {
+        const QPolygon vertices = m_polygon;
+        m_polygon.clear();
+        emit paintPolygonRequested(vertices, m_shapeSide);
+        update();
+        return event->accept();
+    }
+
+    mousePressEvent(event);
+}
@@ -12,6 +12,9 @@
 #include <QSlider>
 #include <QStringLiteral>
 #include <UiUtils.hpp>
+#include <algorithm>
+#include <span>
+#include <vector>
 
 using namespace app::ui;
 
@@ -33,10 +36,11 @@ MainWindow::~MainWindow() = default;
 
 void MainWindow::initModel()
 {
-    model.usMap = std::make_unique<UsMap>(Config::Map::usSvgPath, Config::Grid::gridCols,
-                                          Config::Grid::gridRows);
+    const int cols = Config::Grid::colsFor(Config::Grid::defaultCellSize);
+    const int rows = Config::Grid::rowsFor(Config::Grid::defaultCellSize);
 
-    model.simulation = std::make_unique<Simulation>(Config::Grid::gridCols, Config::Grid::gridRows);
+    model.usMap      = std::make_unique<UsMap>(Config::Map::usSvgPath, cols, rows);
+    model.simulation = std::make_unique<Simulation>(cols, rows);
 
     model.timer = new QTimer(this);
 }
@@ -67,7 +71,31 @@ void MainWindow::createWidgets()
 
     ui.scenarioPresetLabel = makeWidget<QLabel>(this, nullptr, Config::UiText::scenarioPreset);
     ui.scenarioPresetCombo = makeWidget<QComboBox>(
-        this, [](auto* comboBox) { comboBox->addItems({Config::UiText::scenario1}); });
+        this,
+        [](auto* comboBox)
+        {
+            // Kolejność odpowiada wartościom SeedPattern
+            comboBox->addItems({Config::UiText::seedUniform, Config::UiText::seedClustered,
+                                Config::UiText::seedStateQuota, Config::UiText::seedGradient});
+        });
+
+    ui.resolutionLabel = makeWidget<QLabel>(this, nullptr, Config::UiText::resolution);
+    ui.resolutionCombo = makeWidget<QComboBox>(
+        this,
+        [](auto* comboBox)
+        {
+            // Kolejność odpowiada Config::Grid::cellSizes
+            for (const int cellSize : Config::Grid::cellSizes)
+            {
+                comboBox->addItem(Config::UiText::resolutionItem
+                                      .arg(Config::Grid::colsFor(cellSize))
+                                      .arg(Config::Grid::rowsFor(cellSize)));
+                if (cellSize == Config::Grid::defaultCellSize)
+                {
+                    comboBox->setCurrentIndex(comboBox->count() - 1);
+                }
+            }
+        });
 
     ui.playerSettingsLabel = makeWidget<QLabel>(this, nullptr, Config::UiText::playerSettings);
     ui.gridToggle          = makeWidget<QCheckBox>(
@@ -76,6 +104,49 @@ void MainWindow::createWidgets()
         makeWidget<QCheckBox>(this, [](auto* c) { c->setChecked(false); }, Config::UiText::useMap);
     ui.paintToggle = makeWidget<QCheckBox>(
         this, [](auto* c) { c->setChecked(false); }, Config::UiText::paintMode);
+    ui.paintToolCombo = makeWidget<QComboBox>(
+        this,
+        [](auto* comboBox)
+        {
+            // Kolejność odpowiada wartościom PaintTool
+            comboBox->addItems({Config::UiText::toolBrush, Config::UiText::toolRectangle,
+                                Config::UiText::toolPolygon, Config::UiText::toolStateFill,
+                                Config::UiText::toolStateSeed});
+        });
+    ui.brushRadiusSpin = makeWidget<QSpinBox>(
+        this, [](QSpinBox* s) { s->setRange(0, Config::GridWidget::maxBrushRadius); });
+    ui.seedPercentSpin = makeWidget<QSpinBox>(
+        this,
+        [](QSpinBox* s)
+        {
+            s->setRange(1, 100);
+            s->setValue(Config::GridWidget::defaultSeedPercent);
+        });
+
+    ui.overlayLabel = makeWidget<QLabel>(this, nullptr, Config::UiText::overlay);
+    ui.overlayCombo = makeWidget<QComboBox>(
+        this,
+        [](auto* comboBox)
+        {
+            // Kolejność odpowiada wartościom OverlayMode
+            comboBox->addItems({Config::UiText::overlaySide, Config::UiText::overlayHysteresis,
+                                Config::UiText::overlayThreshold, Config::UiText::overlayField,
+                                Config::UiText::overlayFlipAge});
+        });
+
+    ui.saveCheckpointButton =
+        makeWidget<QPushButton>(this, nullptr, Config::UiText::saveCheckpoint);
+    ui.loadCheckpointButton =
+        makeWidget<QPushButton>(this, nullptr, Config::UiText::loadCheckpoint);
+    ui.recordTrajectoryButton =
+        makeWidget<QPushButton>(this, nullptr, Config::UiText::recordTrajectory);
+
+    ui.replayOpenButton  = makeWidget<QPushButton>(this, nullptr, Config::UiText::openReplay);
+    ui.replayCloseButton = makeWidget<QPushButton>(
+        this, [](QPushButton* b) { b->setEnabled(false); }, Config::UiText::closeReplay);
+    ui.replaySlider = makeWidget<QSlider>(
+        this, [](QSlider* s) { s->setEnabled(false); }, Qt::Horizontal);
+    ui.replayLabel = makeWidget<QLabel>(this, nullptr, Config::UiText::replayIdle);
 
     ui.toggleViewButton = makeWidget<QPushButton>(
         this, [](auto* b) { b->setCheckable(true); }, Config::UiText::showStats);
@@ -99,6 +170,23 @@ void MainWindow::createWidgets()
     {
         qWarning() << "Failed to build map: " << error;
     }
+    else
+    {
+        // Stany mapy jako regiony statystyk: liczone w kroku symulacji, pokazywane w StatsWidget
+        const int regionCount = model.usMap->stateCount();
+        model.simulation->setStateIds(model.usMap->getProducts().stateIds, regionCount);
+
+        QStringList codes;
+        QStringList names;
+        for (int state = 0; state < regionCount; ++state)
+        {
+            codes.append(model.usMap->getStateId(static_cast<uint8_t>(state)));
+            names.append(model.usMap->getStateName(static_cast<uint8_t>(state)));
+        }
+        ui.statsWidget->setRegions(codes, names);
+        ui.playerAWidget->setRegions(codes, names);
+        ui.playerBWidget->setRegions(codes, names);
+    }
     ui.gridWidget->setUsMap(model.usMap.get());
 }
 
@@ -160,6 +248,14 @@ void MainWindow::buildLayout()
     auto* left       = new QWidget(centralWidget);
     auto* leftLayout = new QVBoxLayout(left);
     leftLayout->addWidget(ui.contentStack, 1);
+
+    // Replay
+    auto* replayLayout = new QHBoxLayout();
+    replayLayout->addWidget(ui.replayOpenButton);
+    replayLayout->addWidget(ui.replaySlider, 1);
+    replayLayout->addWidget(ui.replayLabel);
+    replayLayout->addWidget(ui.replayCloseButton);
+    leftLayout->addLayout(replayLayout);
     leftLayout->addStretch();
 
     mainLayout->addWidget(left, Config::Layout::leftPanelStretch);
@@ -176,16 +272,46 @@ void MainWindow::buildLayout()
     rightLayout->addWidget(ui.scenarioPresetLabel);
     rightLayout->addWidget(ui.scenarioPresetCombo);
 
+    // Resolution
+    auto* resolutionLayout = new QHBoxLayout();
+    resolutionLayout->addWidget(ui.resolutionLabel);
+    resolutionLayout->addWidget(ui.resolutionCombo, 1);
+    rightLayout->addLayout(resolutionLayout);
+
     // Checkboxes
     auto* checksLayout = new QHBoxLayout();
     checksLayout->addWidget(ui.gridToggle);
     checksLayout->addWidget(ui.mapToggle);
     rightLayout->addLayout(checksLayout);
 
+    // Overlay
+    auto* overlayLayout = new QHBoxLayout();
+    overlayLayout->addWidget(ui.overlayLabel);
+    overlayLayout->addWidget(ui.overlayCombo, 1);
+    rightLayout->addLayout(overlayLayout);
+
+    // Checkpoint
+    auto* checkpointLayout = new QHBoxLayout();
+    checkpointLayout->addWidget(ui.saveCheckpointButton);
+    checkpointLayout->addWidget(ui.loadCheckpointButton);
+    rightLayout->addLayout(checkpointLayout);
+    rightLayout->addWidget(ui.recordTrajectoryButton);
+
     // Player settings
     ui.playerSettingsLabel->setStyleSheet("font-weight: bold; font-size: 13px;");
     rightLayout->addWidget(ui.playerSettingsLabel);
-    rightLayout->addWidget(ui.paintToggle);
+
+    // Paint tools
+    auto* paintLayout = new QHBoxLayout();
+    paintLayout->addWidget(ui.paintToggle);
+    paintLayout->addWidget(ui.paintToolCombo, 1);
+    rightLayout->addLayout(paintLayout);
+    auto* paintSizeLayout = new QHBoxLayout();
+    paintSizeLayout->addWidget(new QLabel(Config::UiText::brushRadius));
+    paintSizeLayout->addWidget(ui.brushRadiusSpin, 1);
+    paintSizeLayout->addWidget(new QLabel(Config::UiText::seedPercent));
+    paintSizeLayout->addWidget(ui.seedPercentSpin, 1);
+    rightLayout->addLayout(paintSizeLayout);
 
     // Player tabs
     rightLayout->addWidget(ui.tabsWidget, 1);
@@ -235,7 +361,7 @@ void MainWindow::wireAll()
     wireGrid();
     wireTogglesAndView();
 
-    connect(model.timer, &QTimer::timeout, this, &MainWindow::doStep, Qt::UniqueConnection);
+    connect(model.timer, &QTimer::timeout, this, &MainWindow::onTimerTick, Qt::UniqueConnection);
 }
 
 void MainWindow::wireSimulationControls()
@@ -248,8 +374,14 @@ void MainWindow::wireSimulationControls()
             &MainWindow::onStepClicked);
     connect(ui.simulationControlWidget, &SimulationControlWidget::speedChanged, this,
             &MainWindow::onSimulationSpeedChanged);
+    connect(ui.simulationControlWidget, &SimulationControlWidget::turboChanged, this,
+            &MainWindow::onTurboChanged);
+    connect(ui.simulationControlWidget, &SimulationControlWidget::stepsPerFrameChanged, this,
+            &MainWindow::onStepsPerFrameChanged);
     connect(ui.simulationControlWidget, &SimulationControlWidget::neighbourhoodChanged, this,
             &MainWindow::onNeighbourhoodChanged);
+    connect(ui.resolutionCombo, QOverload<int>::of(&QComboBox::currentIndexChanged), this,
+            &MainWindow::onResolutionChanged);
     connect(ui.physics, &WorldPhysicsWidget::parametersChanged, this,
             [this]() { model.simulation->setParameters(ui.physics->getParameters()); });
 }
@@ -271,6 +403,20 @@ void MainWindow::wirePlayers()
 
     connect(ui.playerAWidget, &PlayerControlWidget::controlsChanged, this, syncPlayers);
     connect(ui.playerBWidget, &PlayerControlWidget::controlsChanged, this, syncPlayers);
+
+    // Wybór stanów nie zmienia kosztu kampanii, tylko to, gdzie trafia jej sygnał
+    connect(ui.playerAWidget, &PlayerControlWidget::targetingChanged, this,
+            [this]
+            {
+                model.simulation->setRegionAllocation(Side::A,
+                                                      ui.playerAWidget->getRegionWeights());
+            });
+    connect(ui.playerBWidget, &PlayerControlWidget::targetingChanged, this,
+            [this]
+            {
+                model.simulation->setRegionAllocation(Side::B,
+                                                      ui.playerBWidget->getRegionWeights());
+            });
 }
 
 void MainWindow::wireGrid()
@@ -290,11 +436,36 @@ void MainWindow::wireGrid()
     connect(ui.gridWidget, &GridWidget::cellInfoChanged, this, [this](const QString& info)
             { ui.cellInfoLabel->setText(info.isEmpty() ? QStringLiteral("Cell N/A") : info); });
 
-    connect(ui.gridWidget, &GridWidget::paintCellRequested, this,
-            [this](int x, int y, Side side)
+    // Malowanie dotyczy symulacji, nie nagrania. Każde pociągnięcie to jedna operacja
+    // na symulacji i odświeżenie tylko zmienionych komórek.
+    connect(ui.gridWidget, &GridWidget::paintBrushRequested, this,
+            [this](QPoint from, QPoint to, Side side)
             {
-                model.simulation->cellAt(x, y).side = side;
-                ui.gridWidget->update();
+                closeReplay();
+                applyPaint(
+                    model.simulation->paintBrush(from, to, ui.brushRadiusSpin->value(), side));
+            });
+    connect(ui.gridWidget, &GridWidget::paintRectRequested, this,
+            [this](const QRect& cells, Side side)
+            {
+                closeReplay();
+                applyPaint(model.simulation->paintRect(cells, side));
+            });
+    connect(ui.gridWidget, &GridWidget::paintPolygonRequested, this,
+            [this](const QPolygon& vertices, Side side)
+            {
+                closeReplay();
+                applyPaint(model.simulation->paintPolygon(vertices, side));
+            });
+    connect(ui.gridWidget, &GridWidget::paintStateRequested, this,
+            [this](uint8_t stateId, Side side)
+            {
+                closeReplay();
+                const auto   tool     = static_cast<PaintTool>(ui.paintToolCombo->currentIndex());
+                const double fraction = ui.seedPercentSpin->value() / 100.0;
+                applyPaint((tool == PaintTool::STATE_SEED)
+                               ? model.simulation->seedState(stateId, side, fraction)
+                               : model.simulation->paintState(stateId, side));
             });
 }
 
@@ -302,14 +473,43 @@ void MainWindow::wireTogglesAndView()
 {
     connect(ui.gridToggle, &QCheckBox::toggled, ui.gridWidget, &GridWidget::setShowGrid);
     connect(ui.mapToggle, &QCheckBox::toggled, ui.gridWidget, &GridWidget::setMapMode);
+    connect(ui.mapToggle, &QCheckBox::toggled, this,
+            [this](bool on)
+            {
+                // Tło mapy wypada z symulacji; inny obszar to nowy przebieg, więc reset
+                model.simulation->setActiveMask(
+                    on ? model.usMap->getProducts().activeStates : std::vector<uint8_t>{});
+                onResetClicked();
+            });
+    connect(ui.scenarioPresetCombo, QOverload<int>::of(&QComboBox::currentIndexChanged), this,
+            [this](int index)
+            {
+                // Inne warunki początkowe to nowy przebieg
+                model.simulation->setSeedPattern(static_cast<SeedPattern>(index));
+                onResetClicked();
+            });
     connect(ui.paintToggle, &QCheckBox::toggled, ui.gridWidget, &GridWidget::setPaintMode);
+    connect(ui.paintToolCombo, QOverload<int>::of(&QComboBox::currentIndexChanged), this,
+            [this](int index) { ui.gridWidget->setPaintTool(static_cast<PaintTool>(index)); });
+    connect(ui.overlayCombo, QOverload<int>::of(&QComboBox::currentIndexChanged), this,
+            &MainWindow::onOverlayChanged);
 
     connect(ui.toggleViewButton, &QPushButton::toggled, this, &MainWindow::onToggleView);
+    connect(ui.saveCheckpointButton, &QPushButton::clicked, this, &MainWindow::onSaveCheckpoint);
+    connect(ui.loadCheckpointButton, &QPushButton::clicked, this, &MainWindow::onLoadCheckpoint);
+    connect(ui.recordTrajectoryButton, &QPushButton::clicked, this,
+            &MainWindow::onRecordTrajectory);
+
+    connect(ui.replayOpenButton, &QPushButton::clicked, this, &MainWindow::onOpenReplay);
+    connect(ui.replayCloseButton, &QPushButton::clicked, this, &MainWindow::closeReplay);
+    connect(ui.replaySlider, &QSlider::valueChanged, this, &MainWindow::onReplaySeek);
 }
 
 void MainWindow::applyDefaults()
 {
-    onSimulationSpeedChanged(ui.simulationControlWidget->getSpeed());
+    // Tempo z widżetu: w turbo interwał klatki, inaczej interwał z suwaka prędkości
+    model.fixedStepsPerFrame = ui.simulationControlWidget->getStepsPerFrame();
+    onTurboChanged(ui.simulationControlWidget->isTurbo());
     ui.simulationControlWidget->setNeighbourhood(0);
 
     model.simulation->setParameters(ui.physics->getParameters());
@@ -339,10 +539,13 @@ void MainWindow::countFps()
     const qint64 elapsedMs = model.fpsTimer.elapsed();
     if (elapsedMs >= 1000)
     {
-        ui.fpsLabel->setText(QStringLiteral("FPS: %1").arg(model.fpsFrameCount));
+        ui.fpsLabel->setText(QStringLiteral("FPS: %1 | it/s: %2")
+                                 .arg(model.fpsFrameCount)
+                                 .arg(model.fpsStepCount * 1000 / static_cast<int>(elapsedMs)));
         updateOverlayLabelsPosition();
 
         model.fpsFrameCount = 0;
+        model.fpsStepCount  = 0;
         model.fpsTimer.restart();
     }
 }
@@ -376,6 +579,8 @@ void MainWindow::doStep()
     countFps();
 
     model.simulation->step();
+    model.trajectory.record(*model.simulation);
+    ++model.fpsStepCount;
     ui.gridWidget->update();
 
     updateIterationLabel();
@@ -384,6 +589,56 @@ void MainWindow::doStep()
     updateStats();
 }
 
+void MainWindow::doTurboFrame()
+{
+    countFps();
+
+    const int steps =
+        (model.fixedStepsPerFrame > 0) ? model.fixedStepsPerFrame : model.stepsPerFrame;
+
+    QElapsedTimer frameTimer;
+    frameTimer.start();
+
+    for (int i = 0; i < steps; ++i)
+    {
+        model.simulation->step();
+        model.trajectory.record(*model.simulation);
+        updateStats();
+    }
+
+    model.fpsStepCount += steps;
+    adaptStepsPerFrame(static_cast<double>(frameTimer.nsecsElapsed()) / 1.0e6 /
+                       static_cast<double>(steps));
+
+    // Jeden repaint na klatkę, niezależnie od liczby kroków
+    ui.gridWidget->update();
+    updateIterationLabel();
+    refreshBudgets();
+}
+
+void MainWindow::adaptStepsPerFrame(double stepMs)
+{
+    const double alpha = Config::Timing::stepTimeSmoothing;
+    model.avgStepMs =
+        (model.avgStepMs <= 0.0) ? stepMs : (1.0 - alpha) * model.avgStepMs + alpha * stepMs;
+
+    const double fit = Config::Timing::turboFrameBudgetMs / std::max(model.avgStepMs, 1e-3);
+
+    model.stepsPerFrame =
+        std::clamp(static_cast<int>(fit), 1, Config::Timing::turboMaxStepsPerFrame);
+}
+
+void MainWindow::onTimerTick()
+{
+    if (model.turbo)
+    {
+        doTurboFrame();
+        return;
+    }
+
+    doStep();
+}
+
 void MainWindow::onStartClicked()
 {
     if (model.timer->isActive())
@@ -394,7 +649,10 @@ void MainWindow::onStartClicked()
     }
     else
     {
+        closeReplay();
+
         model.fpsFrameCount = 0;
+        model.fpsStepCount  = 0;
         model.fpsTimer.restart();
 
         model.timer->start();
@@ -406,7 +664,12 @@ void MainWindow::onResetClicked()
 {
     model.timer->stop();
     model.fpsFrameCount = 0;
+    model.fpsStepCount  = 0;
+    model.stepsPerFrame = 1;
+    model.avgStepMs     = 0.0;
 
+    stopTrajectoryRecording();
+    closeReplay();
     model.simulation->reset();
 
     ui.gridWidget->clearMap();
@@ -432,6 +695,7 @@ void MainWindow::onStepClicked()
         ui.simulationControlWidget->updateState(false);
     }
 
+    closeReplay();
     doStep();
 }
 
@@ -444,6 +708,237 @@ void MainWindow::onToggleView(bool checked)
                                          : Config::UiText::showStats);
 }
 
+void MainWindow::onOverlayChanged(int index)
+{
+    const auto mode = static_cast<OverlayMode>(index);
+
+    // Pole h liczy się w kroku tylko wtedy, gdy ktoś je ogląda
+    model.simulation->setFieldCapture(mode == OverlayMode::FIELD);
+    ui.gridWidget->setOverlayMode(mode);
+}
+
+void MainWindow::onSaveCheckpoint()
+{
+    const QString path = QFileDialog::getSaveFileName(this, Config::UiText::saveCheckpoint,
+                                                      "state.pckpt",
+                                                      Config::UiText::checkpointFilter);
+    if (path.isEmpty())
+    {
+        return;
+    }
+
+    QString error;
+    if (not model.simulation->saveCheckpoint(path, &error))
+    {
+        QMessageBox::warning(this, Config::UiText::saveCheckpoint, error);
+    }
+}
+
+void MainWindow::onLoadCheckpoint()
+{
+    const QString path = QFileDialog::getOpenFileName(this, Config::UiText::loadCheckpoint, {},
+                                                      Config::UiText::checkpointFilter);
+    if (path.isEmpty())
+    {
+        return;
+    }
+
+    model.timer->stop();
+    ui.simulationControlWidget->updateState(false);
+    stopTrajectoryRecording();
+    closeReplay();
+
+    QString error;
+    if (not model.simulation->loadCheckpoint(path, &error))
+    {
+        QMessageBox::warning(this, Config::UiText::loadCheckpoint, error);
+        return;
+    }
+
+    // UI ma pokazać wczytany stan, ale bez odsyłania go z powrotem do symulacji
+    // (zmiana sąsiedztwa przebudowałaby wczytany graf społeczny)
+    ui.physics->setParameters(model.simulation->getParameters());
+    {
+        const QSignalBlocker blocker(ui.simulationControlWidget);
+        ui.simulationControlWidget->setNeighbourhood(
+            static_cast<int>(model.simulation->getNeighbourhoodType()));
+    }
+    {
+        // Gracze (suwaki i budżet) pochodzą z pliku; syncPlayers nadpisałby je starymi
+        const QSignalBlocker blockerA(ui.playerAWidget);
+        const QSignalBlocker blockerB(ui.playerBWidget);
+        ui.playerAWidget->setControls(model.simulation->getPlayerA().controls);
+        ui.playerBWidget->setControls(model.simulation->getPlayerB().controls);
+    }
+    {
+        // Maska też jest z pliku; przełącznik mapy tylko ją pokazuje (bez resetu przebiegu)
+        const bool           masked = not model.simulation->getActiveMask().empty();
+        const QSignalBlocker blocker(ui.mapToggle);
+        ui.mapToggle->setChecked(masked);
+        ui.gridWidget->setMapMode(masked);
+    }
+
+    clearStats();
+    if (model.simulation->getIteration() > 0)
+    {
+        updateStats();
+    }
+
+    ui.gridWidget->update();
+    updateIterationLabel();
+    refreshBudgets();
+}
+
+void MainWindow::onRecordTrajectory()
+{
+    if (model.trajectory.isRunning())
+    {
+        stopTrajectoryRecording();
+        return;
+    }
+
+    const QString path = QFileDialog::getSaveFileName(this, Config::UiText::recordTrajectory,
+                                                      "run.ptraj",
+                                                      Config::UiText::trajectoryFilter);
+    if (path.isEmpty())
+    {
+        return;
+    }
+
+    QString error;
+    if (not model.trajectory.start(path, *model.simulation, &error))
+    {
+        QMessageBox::warning(this, Config::UiText::recordTrajectory, error);
+        return;
+    }
+    ui.recordTrajectoryButton->setText(Config::UiText::stopTrajectory);
+}
+
+void MainWindow::stopTrajectoryRecording()
+{
+    if (not model.trajectory.isRunning())
+    {
+        return;
+    }
+
+    model.trajectory.stop();
+    ui.recordTrajectoryButton->setText(Config::UiText::recordTrajectory);
+    if (model.trajectory.hasFailed())
+    {
+        QMessageBox::warning(this, Config::UiText::recordTrajectory,
+                             "Writing the trajectory file failed.");
+    }
+}
+
+void MainWindow::onOpenReplay()
+{
+    const QString path = QFileDialog::getOpenFileName(this, Config::UiText::openReplay, {},
+                                                      Config::UiText::trajectoryFilter);
+    if (path.isEmpty())
+    {
+        return;
+    }
+
+    model.timer->stop();
+    ui.simulationControlWidget->updateState(false);
+    stopTrajectoryRecording(); // nie da się odtwarzać pliku, który jest właśnie zapisywany
+    closeReplay();
+
+    QString error;
+    if (not model.replay.open(path, &error))
+    {
+        QMessageBox::warning(this, Config::UiText::openReplay, error);
+        return;
+    }
+    if (model.replay.cols() not_eq model.simulation->getCols() or
+        model.replay.rows() not_eq model.simulation->getRows())
+    {
+        model.replay.close();
+        QMessageBox::warning(this, Config::UiText::openReplay,
+                             QString("Recorded grid %1x%2 does not match the simulation.")
+                                 .arg(model.replay.cols())
+                                 .arg(model.replay.rows()));
+        return;
+    }
+
+    const auto& records = model.replay.records();
+    {
+        const QSignalBlocker blocker(ui.replaySlider);
+        ui.replaySlider->setRange(records.front().iteration, records.back().iteration);
+        ui.replaySlider->setValue(records.front().iteration);
+    }
+    ui.replaySlider->setEnabled(true);
+    ui.replayCloseButton->setEnabled(true);
+
+    ui.gridWidget->setSideOverride(&model.replay.sides());
+    fillStatsFromReplay();
+    onReplaySeek(ui.replaySlider->value());
+}
+
+void MainWindow::onReplaySeek(int iteration)
+{
+    if (not model.replay.isOpen())
+    {
+        return;
+    }
+
+    QString error;
+    if (not model.replay.seek(iteration, &error))
+    {
+        closeReplay();
+        QMessageBox::warning(this, Config::UiText::openReplay, error);
+        return;
+    }
+
+    ui.replayLabel->setText(Config::UiText::replayPosition.arg(model.replay.currentIteration())
+                                .arg(model.replay.records().back().iteration));
+    ui.gridWidget->update();
+}
+
+void MainWindow::closeReplay()
+{
+    if (not model.replay.isOpen())
+    {
+        return;
+    }
+
+    ui.gridWidget->setSideOverride(nullptr);
+    model.replay.close();
+
+    ui.replaySlider->setEnabled(false);
+    ui.replayCloseButton->setEnabled(false);
+    ui.replayLabel->setText(Config::UiText::replayIdle);
+
+    // Wykresy wracają do odłożonej historii bieżącego przebiegu
+    ui.statsWidget->closeReplay();
+    ui.gridWidget->update();
+}
+
+void MainWindow::fillStatsFromReplay()
+{
+    // W nagraniu są tylko liczności stron, reszta metryk zostaje zerowa
+    const auto&            records = model.replay.records();
+    std::vector<StepStats> samples;
+    samples.reserve(records.size());
+    for (const auto& record : records)
+    {
+        StepStats stats;
+        stats.iter   = record.iteration;
+        stats.countA = record.countA;
+        stats.countB = record.countB;
+        stats.countN = record.countN;
+        stats.active = record.countA + record.countB + record.countN;
+        if (stats.active > 0)
+        {
+            stats.shareA = static_cast<double>(stats.countA) / stats.active;
+            stats.shareB = static_cast<double>(stats.countB) / stats.active;
+            stats.shareN = static_cast<double>(stats.countN) / stats.active;
+        }
+        samples.push_back(stats);
+    }
+    ui.statsWidget->showReplay(samples);
+}
+
 void MainWindow::onNeighbourhoodChanged(int index)
 {
     auto chosenNeighbourhoodType =
@@ -451,10 +946,61 @@ void MainWindow::onNeighbourhoodChanged(int index)
     model.simulation->setNeighbourhoodType(chosenNeighbourhoodType);
 }
 
+void MainWindow::onResolutionChanged(int index)
+{
+    const auto sizes = std::span(Config::Grid::cellSizes);
+    if (index < 0 or static_cast<std::size_t>(index) >= sizes.size())
+    {
+        return;
+    }
+    const int cols = Config::Grid::colsFor(sizes[static_cast<std::size_t>(index)]);
+    const int rows = Config::Grid::rowsFor(sizes[static_cast<std::size_t>(index)]);
+    if (cols == model.simulation->getCols() and rows == model.simulation->getRows())
+    {
+        return;
+    }
+
+    model.timer->stop();
+    ui.simulationControlWidget->updateState(false);
+    stopTrajectoryRecording(); // nagranie ma jeden rozmiar siatki
+    closeReplay();
+
+    // Produkty mapy w nowym rozmiarze; po pierwszym razie czytane z cache na dysku
+    model.usMap->setGridSize(cols, rows);
+    QString    error;
+    const bool mapBuilt = model.usMap->buildStateProducts(&error);
+    if (not mapBuilt)
+    {
+        qWarning() << "Failed to build map: " << error;
+    }
+
+    // Przebieg trwa dalej: stan przepróbkowany do nowej siatki, maska mapy jak dotąd
+    const auto& products = model.usMap->getProducts();
+    model.simulation->resize(cols, rows,
+                             (mapBuilt and ui.mapToggle->isChecked()) ? products.activeStates
+                                                                      : std::vector<uint8_t>{});
+    if (mapBuilt)
+    {
+        model.simulation->setStateIds(products.stateIds, model.usMap->stateCount());
+    }
+
+    // Liczności komórek zmieniły skalę, więc wykresy zaczynają się od następnego kroku
+    clearStats();
+
+    ui.gridWidget->update();
+    updateIterationLabel();
+    refreshBudgets();
+}
+
 void MainWindow::onSimulationSpeedChanged(int speed)
 {
-    const int slowInterval = 1000;
-    const int fastInterval = 16;
+    if (model.turbo)
+    {
+        return;
+    }
+
+    const int slowInterval = Config::Timing::slowIntervalMs;
+    const int fastInterval = Config::Timing::fastIntervalMs;
 
     float t           = static_cast<float>(speed) / 100.0f;
     int   newInterval = static_cast<int>(slowInterval + t * (fastInterval - slowInterval));
@@ -462,9 +1008,40 @@ void MainWindow::onSimulationSpeedChanged(int speed)
     model.timer->setInterval(newInterval);
 }
 
+void MainWindow::onTurboChanged(bool on)
+{
+    model.turbo         = on;
+    model.stepsPerFrame = 1;
+    model.avgStepMs     = 0.0;
+
+    if (on)
+    {
+        model.timer->setInterval(Config::Timing::frameIntervalMs);
+        return;
+    }
+
+    onSimulationSpeedChanged(ui.simulationControlWidget->getSpeed());
+}
+
+void MainWindow::onStepsPerFrameChanged(int steps)
+{
+    model.fixedStepsPerFrame = steps;
+}
+
 void MainWindow::updateStats()
 {
-    ui.statsWidget->pushSample(model.simulation->getlastStepStats());
+    ui.statsWidget->pushSample(model.simulation->getlastStepStats(),
+                               model.simulation->getLastRegionStats());
+}
+
+void MainWindow::applyPaint(const QRect& dirtyCells)
+{
+    if (dirtyCells.isEmpty())
+    {
+        return;
+    }
+    model.trajectory.requestKeyframe(); // zmiana spoza kroku
+    ui.gridWidget->invalidateCells(dirtyCells);
 }
 
 void MainWindow::clearStats()
@@ -4,6 +4,10 @@
 #include "Model.hpp"
 #include "UiUtils.hpp"
 
+#include <QPushButton>
+#include <QSignalBlocker>
+#include <cmath>
+
 using namespace app::ui;
 
 PlayerControlWidget::PlayerControlWidget(const QString& playerName, QWidget* parent)
@@ -30,9 +34,75 @@ PlayerControlWidget::PlayerControlWidget(const QString& playerName, QWidget* par
                                              m_greySocialSlider, m_blackSocialSlider));
     mainLayout->addWidget(createChannelGroup("DM (Direct Message)", m_whiteDMSlider, m_greyDMSlider,
                                              m_blackDMSlider));
+
+    // Celowanie: zaznaczone stany dostają cały wysiłek kampanii, wszystkie = cały kraj
+    m_targetBox        = new QGroupBox(Config::UiText::targetStates);
+    auto* targetLayout = new QVBoxLayout(m_targetBox);
+    targetLayout->setSpacing(2);
+
+    m_targetList = new QListWidget(m_targetBox);
+    m_targetList->setMaximumHeight(140);
+    auto* allButton = new QPushButton(Config::UiText::allStates, m_targetBox);
+
+    targetLayout->addWidget(m_targetList);
+    targetLayout->addWidget(allButton);
+    m_targetBox->setVisible(false);
+    mainLayout->addWidget(m_targetBox);
+
+    connect(m_targetList, &QListWidget::itemChanged, this, [this] { emit targetingChanged(); });
+    connect(allButton, &QPushButton::clicked, this,
+            [this]
+            {
+                {
+                    const QSignalBlocker blocker(m_targetList);
+                    for (int i = 0; i < m_targetList->count(); ++i)
+                    {
+                        m_targetList->item(i)->setCheckState(Qt::Checked);
+                    }
+                }
+                emit targetingChanged();
+            });
+
     mainLayout->addStretch();
 }
 
+void PlayerControlWidget::setRegions(const QStringList& codes, const QStringList& names)
+{
+    {
+        const QSignalBlocker blocker(m_targetList);
+        m_targetList->clear();
+        for (qsizetype i = 0; i < codes.size(); ++i)
+        {
+            auto* item = new QListWidgetItem(QString("%1  %2").arg(codes[i], names.value(i)));
+            item->setFlags(item->flags() bitor Qt::ItemIsUserCheckable);
+            item->setCheckState(Qt::Checked);
+            m_targetList->addItem(item);
+        }
+    }
+    m_targetBox->setVisible(not codes.isEmpty());
+    emit targetingChanged();
+}
+
+std::vector<float> PlayerControlWidget::getRegionWeights() const
+{
+    std::vector<float> weights(static_cast<std::size_t>(m_targetList->count()));
+    int                checked = 0;
+    for (int i = 0; i < m_targetList->count(); ++i)
+    {
+        if (m_targetList->item(i)->checkState() == Qt::Checked)
+        {
+            weights[static_cast<std::size_t>(i)] = 1.0f;
+            ++checked;
+        }
+    }
+
+    if (checked == 0 or checked == m_targetList->count())
+    {
+        return {};
+    }
+    return weights;
+}
+
 QGroupBox* PlayerControlWidget::createChannelGroup(const QString& title,
                                                    QSlider*&      white,
                                                    QSlider*&      grey,
@@ -116,6 +186,27 @@ Controls PlayerControlWidget::getControls() const
     return controls;
 }
 
+void PlayerControlWidget::setControls(const Controls& controls)
+{
+    // Odwrotność getControls: 0.0-1.0 -> 0-100
+    auto set = [](QSlider* slider, float value)
+    {
+        slider->setValue(static_cast<int>(std::lround(value * 100.0f)));
+    };
+
+    set(m_whiteBroadcastSlider, controls.whiteBroadcast);
+    set(m_greyBroadcastSlider, controls.greyBroadcast);
+    set(m_blackBroadcastSlider, controls.blackBroadcast);
+
+    set(m_whiteSocialSlider, controls.whiteSocial);
+    set(m_greySocialSlider, controls.greySocial);
+    set(m_blackSocialSlider, controls.blackSocial);
+
+    set(m_whiteDMSlider, controls.whiteDM);
+    set(m_greyDMSlider, controls.greyDM);
+    set(m_blackDMSlider, controls.blackDM);
+}
+
 void PlayerControlWidget::updateBudgetDisplay(float currentBudget, float plannedCost)
 {
     m_budgetLabel->setText(
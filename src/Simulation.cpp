@@ -2,12 +2,15 @@
 
 #include "Constants.hpp"
 #include "Model.hpp"
+#include "Parallel.hpp"
 #include "Types.hpp"
 
 #include <QDebug>
 #include <algorithm>
+#include <cmath>
 #include <random>
 #include <span>
+#include <utility>
 
 namespace
 {
@@ -51,17 +54,117 @@ namespace
             return (signal <= 0.0f) ? signal : signal * openMindFactor;
         }
     }
+
+    std::span<const QVector2D> neighbourOffsets(NeighbourhoodType type)
+    {
+        return (type == NeighbourhoodType::MOORE)
+                   ? std::span<const QVector2D>(Config::Neighbourhood::MOORE)
+                   : std::span<const QVector2D>(Config::Neighbourhood::VN);
+    }
+
+    const CellData kOutsideCell{.active = false};
+
+    std::size_t seedCount(int count)
+    {
+        return static_cast<std::size_t>(std::max(0, count));
+    }
+
+    // Wątki do bloków losowania, każdy z co najmniej minCellsPerWorker komórkami
+    unsigned seedWorkers(std::size_t blocks, std::size_t cells)
+    {
+        const unsigned workers =
+            Parallel::workerCount(cells, Config::Simulation::minCellsPerWorker);
+        return static_cast<unsigned>(std::clamp<std::size_t>(blocks, 1, workers));
+    }
+
+    // Ile z need komórek losowanych bez zwracania z pool trafi do bloku o n komórkach.
+    // Rozkład hipergeometryczny przybliżamy dwumianowym i przycinamy tak, żeby reszta
+    // zawsze zmieściła się w pozostałych blokach - suma po blokach jest więc dokładna.
+    std::size_t blockShare(std::size_t n, std::size_t need, std::size_t pool, std::mt19937& rng)
+    {
+        if (need == 0 or n == 0)
+        {
+            return 0;
+        }
+        const std::size_t rest = pool - n;
+        const std::size_t lo   = need > rest ? need - rest : 0;
+        const std::size_t hi   = std::min(need, n);
+
+        std::binomial_distribution<std::size_t> share(
+            n, static_cast<double>(need) / static_cast<double>(pool));
+        return std::clamp(share(rng), lo, hi);
+    }
+
+    // Rozdział total proporcjonalnie do wag, bez przekraczania pojemności (nadmiar przechodzi
+    // na resztę, ostatnie sztuki dostają największe reszty z dzielenia)
+    std::vector<std::size_t> distributeQuota(std::size_t                  total,
+                                             std::span<const double>      weights,
+                                             std::span<const std::size_t> capacity)
+    {
+        std::vector<std::size_t> quota(capacity.size(), 0);
+
+        std::size_t room = 0;
+        for (const std::size_t c : capacity)
+        {
+            room += c;
+        }
+        std::size_t remaining = std::min(total, room);
+
+        while (remaining > 0)
+        {
+            // Bez wag przy wolnym miejscu dzielimy po prostu według wolnego miejsca
+            double weightSum = 0.0;
+            for (std::size_t i = 0; i < quota.size(); ++i)
+            {
+                weightSum += (quota[i] < capacity[i]) ? weights[i] : 0.0;
+            }
+            const bool byRoom = weightSum <= 0.0;
+            if (byRoom)
+            {
+                weightSum = static_cast<double>(room);
+            }
+
+            std::size_t added    = 0;
+            std::size_t best     = quota.size();
+            double      bestFrac = -1.0;
+            for (std::size_t i = 0; i < quota.size(); ++i)
+            {
+                const std::size_t left = capacity[i] - quota[i];
+                if (left == 0)
+                {
+                    continue;
+                }
+                const double weight = byRoom ? static_cast<double>(left) : weights[i];
+                const double share  = static_cast<double>(remaining) * weight / weightSum;
+                const auto   take   = std::min(left, static_cast<std::size_t>(share));
+                quota[i] += take;
+                added += take;
+
+                const double frac = share - std::floor(share);
+                if (take < left and frac > bestFrac)
+                {
+                    best     = i;
+                    bestFrac = frac;
+                }
+            }
+            if (added == 0 and best < quota.size())
+            {
+                ++quota[best];
+                added = 1;
+            }
+            remaining -= added;
+            room -= added;
+        }
+        return quota;
+    }
 } // namespace
 
 Simulation::Simulation(int cols, int rows)
-    : m_cols{cols},
-      m_rows{rows},
-      m_currentGrid{static_cast<std::size_t>(cols) * static_cast<std::size_t>(rows)},
-      m_nextGrid{static_cast<std::size_t>(cols) * static_cast<std::size_t>(rows)},
-      m_rng{std::random_device{}()}
-{
-    m_flipTracker.assign(static_cast<std::size_t>(cols) * static_cast<std::size_t>(rows), {});
-    seedRandomly(2500, 2500);
+    : m_cols{cols}, m_rows{rows}, m_rng{std::random_device{}()}
+{
+    rebuildActiveSpans({});
+    allocateCells();
+    seedInitialState();
     buildSocialNetwork(0.05f);
 }
 
@@ -79,9 +182,259 @@ void Simulation::setPlayers(const Player& A, const Player& B)
 void Simulation::setNeighbourhoodType(NeighbourhoodType type)
 {
     m_neighbourhoodType = type;
+    buildNeighbourTable();
     buildSocialNetwork(0.05f);
 }
 
+void Simulation::setFieldCapture(bool on)
+{
+    m_captureField = on;
+    if (on)
+    {
+        m_field.assign(m_currentGrid.size(), 0.0f);
+    }
+    else
+    {
+        m_field.clear();
+        m_field.shrink_to_fit();
+    }
+    ++m_version; // płaszczyzna pola widoku zmienia się razem z flagą
+}
+
+void Simulation::setChangeCapture(bool on)
+{
+    m_captureChanges = on;
+    m_changedCells.clear();
+}
+
+const std::vector<uint32_t>& Simulation::getChangedCells() const
+{
+    return m_changedCells;
+}
+
+void Simulation::copySides(std::vector<uint8_t>& out) const
+{
+    out.assign(gridSize(), static_cast<uint8_t>(Side::NONE));
+    for (int y = 0; y < m_rows; ++y)
+    {
+        for (const CellSpan& span : rowSpans(y))
+        {
+            uint8_t*        dst   = out.data() + idx(span.begin, y);
+            const CellData* cells = m_currentGrid.data() + span.offset;
+            for (int k = 0; k < span.end - span.begin; ++k)
+            {
+                dst[k] = static_cast<uint8_t>(cells[k].side);
+            }
+        }
+    }
+}
+
+bool Simulation::isFieldCaptured() const
+{
+    return m_captureField;
+}
+
+const std::vector<float>& Simulation::getField() const
+{
+    return m_field;
+}
+
+const std::vector<int>& Simulation::getLastFlipIterations() const
+{
+    return m_lastFlipIteration;
+}
+
+void Simulation::setStateIds(const std::vector<uint8_t>& stateIds, int regionCount)
+{
+    if (stateIds.size() not_eq gridSize())
+    {
+        qWarning() << "Simulation: state id plane does not match the grid";
+        return;
+    }
+
+    m_stateIds    = stateIds;
+    m_regionCount = std::clamp(regionCount, 0, 255); // 255 = komórka poza mapą
+    m_lastRegionStats.assign(static_cast<std::size_t>(m_regionCount), {});
+
+    m_regionCells.assign(static_cast<std::size_t>(m_regionCount), 0);
+    for (const uint8_t stateId : m_stateIds)
+    {
+        if (stateId < m_regionCount)
+        {
+            ++m_regionCells[stateId];
+        }
+    }
+    applyStateIds();
+}
+
+void Simulation::setRegionAllocation(Side side, std::vector<float> weights)
+{
+    (side == Side::B ? m_allocationB : m_allocationA) = std::move(weights);
+}
+
+void Simulation::applyStateIds()
+{
+    if (m_stateIds.size() not_eq gridSize())
+    {
+        return;
+    }
+
+    for (int y = 0; y < m_rows; ++y)
+    {
+        for (const CellSpan& span : rowSpans(y))
+        {
+            for (int x = span.begin; x < span.end; ++x)
+            {
+                const std::size_t i      = span.offset + static_cast<std::size_t>(x - span.begin);
+                m_currentGrid[i].stateId = m_stateIds[idx(x, y)];
+                m_nextGrid[i].stateId    = m_currentGrid[i].stateId;
+            }
+        }
+    }
+    ++m_version;
+}
+
+void Simulation::setActiveMask(const std::vector<uint8_t>& mask)
+{
+    if (not mask.empty() and mask.size() not_eq gridSize())
+    {
+        qWarning() << "Simulation: active mask does not match the grid";
+        return;
+    }
+
+    m_activeMask = mask;
+}
+
+const std::vector<uint8_t>& Simulation::getActiveMask() const
+{
+    return m_activeMask;
+}
+
+void Simulation::rebuildActiveSpans(const std::vector<uint8_t>& activePlane)
+{
+    // Pusta płaszczyzna = cała siatka aktywna; numeracja gęsta rośnie wzdłuż odcinków
+    const auto isActive = [&](int x, int y)
+    { return activePlane.empty() or activePlane[idx(x, y)] not_eq 0; };
+
+    m_activeSpans.clear();
+    m_rowSpanStart.assign(static_cast<std::size_t>(m_rows) + 1, 0);
+
+    uint32_t offset = 0;
+    for (int y = 0; y < m_rows; ++y)
+    {
+        m_rowSpanStart[static_cast<std::size_t>(y)] = m_activeSpans.size();
+        int x = 0;
+        while (x < m_cols)
+        {
+            while (x < m_cols and not isActive(x, y))
+            {
+                ++x;
+            }
+            const int begin = x;
+            while (x < m_cols and isActive(x, y))
+            {
+                ++x;
+            }
+            if (x > begin)
+            {
+                m_activeSpans.push_back({begin, x, offset});
+                offset += static_cast<uint32_t>(x - begin);
+            }
+        }
+    }
+    m_rowSpanStart.back() = m_activeSpans.size();
+    m_cellCount           = offset;
+}
+
+void Simulation::allocateCells()
+{
+    m_currentGrid.assign(m_cellCount, {});
+    m_nextGrid.assign(m_cellCount, {});
+    m_flipTracker.assign(m_cellCount, {});
+    m_lastFlipIteration.assign(m_cellCount, 0);
+    if (m_captureField)
+    {
+        m_field.assign(m_cellCount, 0.0f);
+    }
+
+    applyStateIds();
+    buildNeighbourTable();
+    ++m_version;
+}
+
+void Simulation::buildNeighbourTable()
+{
+    const auto offsets = neighbourOffsets(m_neighbourhoodType);
+    m_neighbourCount   = offsets.size();
+    m_neighbours.assign(m_cellCount * m_neighbourCount, -1);
+
+    for (int y = 0; y < m_rows; ++y)
+    {
+        for (const CellSpan& span : rowSpans(y))
+        {
+            for (int x = span.begin; x < span.end; ++x)
+            {
+                const std::size_t i = span.offset + static_cast<std::size_t>(x - span.begin);
+                int32_t*          out = m_neighbours.data() + i * m_neighbourCount;
+                for (const auto& offset : offsets)
+                {
+                    const int nx = x + static_cast<int>(offset.x());
+                    const int ny = y + static_cast<int>(offset.y());
+                    *out++       = static_cast<int32_t>(denseIndex(nx, ny));
+                }
+            }
+        }
+    }
+}
+
+GridView Simulation::view() const
+{
+    GridView view;
+    view.m_cols         = m_cols;
+    view.m_rows         = m_rows;
+    view.m_version      = m_version;
+    view.m_spans        = m_activeSpans;
+    view.m_rowSpanStart = m_rowSpanStart;
+    view.m_cells        = m_currentGrid;
+    view.m_field        = m_field;
+    view.m_lastFlip     = m_lastFlipIteration;
+    return view;
+}
+
+uint64_t Simulation::getVersion() const
+{
+    return m_version;
+}
+
+std::span<const CellSpan> Simulation::rowSpans(int y) const
+{
+    return CellSpans::row(m_activeSpans, m_rowSpanStart, y);
+}
+
+std::ptrdiff_t Simulation::denseIndex(int x, int y) const
+{
+    if (x < 0 or y < 0 or x >= m_cols or y >= m_rows)
+    {
+        return -1;
+    }
+    return CellSpans::denseIndex(rowSpans(y), x);
+}
+
+int Simulation::getRegionCount() const
+{
+    return m_regionCount;
+}
+
+const std::vector<RegionStats>& Simulation::getLastRegionStats() const
+{
+    return m_lastRegionStats;
+}
+
+const BaseParameters& Simulation::getParameters() const
+{
+    return m_parameters;
+}
+
 int Simulation::getIteration() const
 {
     return m_iteration;
@@ -112,83 +465,732 @@ Player Simulation::getPlayerB() const
     return m_playerB;
 }
 
+NeighbourhoodType Simulation::getNeighbourhoodType() const
+{
+    return m_neighbourhoodType;
+}
+
 void Simulation::reset()
 {
-    std::size_t totalCells = static_cast<std::size_t>(m_cols) * static_cast<std::size_t>(m_rows);
-    m_currentGrid          = std::vector<CellData>(totalCells);
-    m_nextGrid             = std::vector<CellData>(totalCells);
-    m_iteration            = 0;
-    m_flipTracker.assign(totalCells, {});
+    m_iteration = 0;
+    rebuildActiveSpans(m_activeMask);
+    allocateCells();
+
     m_broadcastStockA = 0.0f;
     m_broadcastStockB = 0.0f;
 
-    seedRandomly(2500, 2500);
+    m_lastRegionStats.assign(static_cast<std::size_t>(m_regionCount), {});
+
+    seedInitialState();
     buildSocialNetwork(0.05f);
 }
 
-CellData& Simulation::cellAt(int x, int y)
+void Simulation::resize(int cols, int rows, const std::vector<uint8_t>& activeMask)
 {
-    std::vector<CellData>::size_type index =
-        static_cast<std::vector<CellData>::size_type>(y) *
-            static_cast<std::vector<CellData>::size_type>(m_cols) +
-        static_cast<std::vector<CellData>::size_type>(x);
-    return m_currentGrid.at(index);
+    const auto newSize = static_cast<std::size_t>(cols) * static_cast<std::size_t>(rows);
+    if (cols <= 0 or rows <= 0 or (not activeMask.empty() and activeMask.size() not_eq newSize))
+    {
+        qWarning() << "Simulation: invalid grid size or mask for resize";
+        return;
+    }
+
+    // Stary stan: indeks gęsty dla każdej komórki starej siatki (-1 = poza maską)
+    const int                   oldCols = m_cols;
+    const int                   oldRows = m_rows;
+    const std::vector<CellData> oldCells    = std::move(m_currentGrid);
+    const std::vector<int>      oldLastFlip = std::move(m_lastFlipIteration);
+    std::vector<int32_t>        oldDense(gridSize(), -1);
+    for (int y = 0; y < m_rows; ++y)
+    {
+        for (const CellSpan& span : rowSpans(y))
+        {
+            for (int x = span.begin; x < span.end; ++x)
+            {
+                oldDense[idx(x, y)] = static_cast<int32_t>(span.offset) + (x - span.begin);
+            }
+        }
+    }
+
+    m_cols       = cols;
+    m_rows       = rows;
+    m_activeMask = activeMask;
+    // Płaszczyzna stanów jest w starym rozmiarze: do następnego setStateIds() nie ma stanów,
+    // a nowe komórki mają stateId = 255 (poza mapą, domyślne w CellData)
+    m_stateIds.clear();
+    m_regionCount = 0;
+    m_regionCells.clear();
+    m_lastRegionStats.clear();
+    m_changedCells.clear();
+
+    rebuildActiveSpans(m_activeMask);
+    allocateCells();
+
+    // Blok starych komórek [x0, x1) x [y0, y1) pokrywany przez nową komórkę; przy
+    // powiększaniu blok ma jedną komórkę, więc to zwykły najbliższy sąsiad
+    const auto blockBegin = [](int i, int oldCount, int newCount)
+    {
+        return static_cast<int>(static_cast<int64_t>(i) * oldCount / newCount);
+    };
+
+    std::uniform_real_distribution<double> distTheta(0.05, 0.6);
+    for (int y = 0; y < m_rows; ++y)
+    {
+        const int y0 = blockBegin(y, oldRows, m_rows);
+        const int y1 = std::max(y0 + 1, blockBegin(y + 1, oldRows, m_rows));
+        for (const CellSpan& span : rowSpans(y))
+        {
+            std::size_t i = span.offset;
+            for (int x = span.begin; x < span.end; ++x, ++i)
+            {
+                const int x0 = blockBegin(x, oldCols, m_cols);
+                const int x1 = std::max(x0 + 1, blockBegin(x + 1, oldCols, m_cols));
+
+                std::array<int, 3> votes{};
+                double             thresholdSum  = 0.0;
+                double             hysteresisSum = 0.0;
+                int                lastFlip      = 0;
+                int                count         = 0;
+                for (int sy = y0; sy < y1; ++sy)
+                {
+                    const int32_t* oldRow = oldDense.data() + static_cast<std::size_t>(sy) *
+                                                                  static_cast<std::size_t>(oldCols);
+                    for (int sx = x0; sx < x1; ++sx)
+                    {
+                        const int32_t source = oldRow[sx];
+                        if (source < 0)
+                        {
+                            continue;
+                        }
+                        const auto      s   = static_cast<std::size_t>(source);
+                        const CellData& old = oldCells[s];
+                        ++votes[static_cast<std::size_t>(old.side)];
+                        thresholdSum += old.threshold;
+                        hysteresisSum += old.hysteresis;
+                        lastFlip = std::max(lastFlip, oldLastFlip[s]);
+                        ++count;
+                    }
+                }
+
+                CellData& cell = m_currentGrid[i];
+                if (count == 0)
+                {
+                    // Komórka, której wcześniej nie było (np. brzeg maski): jak po seedzie
+                    cell.threshold = distTheta(m_rng);
+                    continue;
+                }
+
+                // Remis A z B zostawia komórkę neutralną
+                const int a = votes[static_cast<std::size_t>(Side::A)];
+                const int b = votes[static_cast<std::size_t>(Side::B)];
+                const int n = votes[static_cast<std::size_t>(Side::NONE)];
+                if (a > b and a >= n)
+                {
+                    cell.side = Side::A;
+                }
+                else if (b > a and b >= n)
+                {
+                    cell.side = Side::B;
+                }
+                cell.threshold         = thresholdSum / static_cast<double>(count);
+                cell.hysteresis        = hysteresisSum / static_cast<double>(count);
+                m_lastFlipIteration[i] = lastFlip;
+            }
+        }
+    }
+    m_nextGrid = m_currentGrid;
+
+    // Graf społeczny łączy konkretne komórki, więc w nowej siatce losujemy go od nowa
+    buildSocialNetwork(0.05f);
 }
+
 const CellData& Simulation::cellAt(int x, int y) const
 {
-    std::vector<CellData>::size_type index =
-        static_cast<std::vector<CellData>::size_type>(y) *
-            static_cast<std::vector<CellData>::size_type>(m_cols) +
-        static_cast<std::vector<CellData>::size_type>(x);
-    return m_currentGrid.at(index);
+    const std::ptrdiff_t i = denseIndex(x, y);
+    return (i < 0) ? kOutsideCell : m_currentGrid[static_cast<std::size_t>(i)];
+}
+
+bool Simulation::setCellSide(int x, int y, Side side)
+{
+    const std::ptrdiff_t i = denseIndex(x, y);
+    if (i < 0)
+    {
+        return false;
+    }
+    m_currentGrid[static_cast<std::size_t>(i)].side = side;
+    ++m_version;
+    return true;
+}
+
+void Simulation::paintRow(int y, int x0, int x1, Side side, QRect& dirty)
+{
+    if (y < 0 or y >= m_rows)
+    {
+        return;
+    }
+
+    int first = m_cols;
+    int last  = -1;
+    for (const CellSpan& span : rowSpans(y))
+    {
+        const int begin = std::max(span.begin, x0);
+        const int end   = std::min(span.end, x1 + 1);
+        for (int x = begin; x < end; ++x)
+        {
+            CellData& cell = m_currentGrid[span.offset + static_cast<std::size_t>(x - span.begin)];
+            if (cell.side not_eq side)
+            {
+                cell.side = side;
+                first     = std::min(first, x);
+                last      = x;
+            }
+        }
+    }
+
+    if (last >= first)
+    {
+        dirty |= QRect(first, y, last - first + 1, 1);
+        ++m_version;
+    }
+}
+
+QRect Simulation::paintBrush(QPoint from, QPoint to, int radius, Side side)
+{
+    // Kapsuła: komórki w odległości <= radius od odcinka from-to. Jest wypukła, więc
+    // w każdym wierszu to jeden przedział kolumn.
+    radius = std::max(radius, 0);
+
+    const double ax = from.x();
+    const double ay = from.y();
+    const double dx = to.x() - from.x();
+    const double dy = to.y() - from.y();
+    const double ll = dx * dx + dy * dy;
+    const double r  = radius + 0.5; // koło o promieniu 0 to jedna komórka
+
+    const auto inside = [&](int x, int y)
+    {
+        const double t  = (ll > 0.0) ? std::clamp(((x - ax) * dx + (y - ay) * dy) / ll, 0.0, 1.0)
+                                     : 0.0;
+        const double ex = x - (ax + t * dx);
+        const double ey = y - (ay + t * dy);
+        return ex * ex + ey * ey <= r * r;
+    };
+
+    const int x0 = std::max(std::min(from.x(), to.x()) - radius, 0);
+    const int x1 = std::min(std::max(from.x(), to.x()) + radius, m_cols - 1);
+    const int y0 = std::max(std::min(from.y(), to.y()) - radius, 0);
+    const int y1 = std::min(std::max(from.y(), to.y()) + radius, m_rows - 1);
+
+    QRect dirty;
+    for (int y = y0; y <= y1; ++y)
+    {
+        int left = x0;
+        while (left <= x1 and not inside(left, y))
+        {
+            ++left;
+        }
+        int right = x1;
+        while (right >= left and not inside(right, y))
+        {
+            --right;
+        }
+        paintRow(y, left, right, side, dirty);
+    }
+    return dirty;
+}
+
+QRect Simulation::paintRect(const QRect& cells, Side side)
+{
+    const QRect area = cells.normalized().intersected(QRect(0, 0, m_cols, m_rows));
+
+    QRect dirty;
+    for (int y = area.top(); y <= area.bottom(); ++y)
+    {
+        paintRow(y, area.left(), area.right(), side, dirty);
+    }
+    return dirty;
+}
+
+QRect Simulation::paintPolygon(const QPolygon& vertices, Side side)
+{
+    if (vertices.size() < 3)
+    {
+        return {};
+    }
+
+    // Scanline po środkach komórek z regułą parzystości; krawędź [y1, y2) liczy się raz
+    const QRect area = vertices.boundingRect().intersected(QRect(0, 0, m_cols, m_rows));
+
+    QRect               dirty;
+    std::vector<double> crossings;
+    for (int y = area.top(); y <= area.bottom(); ++y)
+    {
+        crossings.clear();
+        for (qsizetype k = 0; k < vertices.size(); ++k)
+        {
+            const QPoint& a = vertices[k];
+            const QPoint& b = vertices[(k + 1) % vertices.size()];
+            if ((a.y() <= y and y < b.y()) or (b.y() <= y and y < a.y()))
+            {
+                crossings.push_back(a.x() + static_cast<double>(y - a.y()) * (b.x() - a.x()) /
+                                                (b.y() - a.y()));
+            }
+        }
+        std::sort(crossings.begin(), crossings.end());
+        for (std::size_t k = 0; k + 1 < crossings.size(); k += 2)
+        {
+            paintRow(y, static_cast<int>(std::ceil(crossings[k])),
+                     static_cast<int>(std::floor(crossings[k + 1])), side, dirty);
+        }
+    }
+    return dirty;
+}
+
+QRect Simulation::paintState(uint8_t stateId, Side side)
+{
+    QRect dirty;
+    for (int y = 0; y < m_rows; ++y)
+    {
+        int first = m_cols;
+        int last  = -1;
+        for (const CellSpan& span : rowSpans(y))
+        {
+            std::size_t i = span.offset;
+            for (int x = span.begin; x < span.end; ++x, ++i)
+            {
+                CellData& cell = m_currentGrid[i];
+                if (cell.stateId == stateId and cell.side not_eq side)
+                {
+                    cell.side = side;
+                    first     = std::min(first, x);
+                    last      = x;
+                }
+            }
+        }
+        if (last >= first)
+        {
+            dirty |= QRect(first, y, last - first + 1, 1);
+            ++m_version;
+        }
+    }
+    return dirty;
+}
+
+QRect Simulation::seedState(uint8_t stateId, Side side, double fraction)
+{
+    // Komórki stanu (indeks gęsty + pozycja), potem częściowy Fisher-Yates na ułamku
+    struct Candidate
+    {
+            std::size_t index;
+            int         x;
+            int         y;
+    };
+    std::vector<Candidate> candidates;
+    for (int y = 0; y < m_rows; ++y)
+    {
+        for (const CellSpan& span : rowSpans(y))
+        {
+            std::size_t i = span.offset;
+            for (int x = span.begin; x < span.end; ++x, ++i)
+            {
+                if (m_currentGrid[i].stateId == stateId)
+                {
+                    candidates.push_back({i, x, y});
+                }
+            }
+        }
+    }
+
+    const auto count = static_cast<std::size_t>(
+        std::lround(std::clamp(fraction, 0.0, 1.0) * static_cast<double>(candidates.size())));
+
+    QRect dirty;
+    for (std::size_t k = 0; k < count; ++k)
+    {
+        std::uniform_int_distribution<std::size_t> pick(k, candidates.size() - 1);
+        std::swap(candidates[k], candidates[pick(m_rng)]);
+
+        const Candidate& c    = candidates[k];
+        CellData&        cell = m_currentGrid[c.index];
+        if (cell.side not_eq side)
+        {
+            cell.side = side;
+            dirty |= QRect(c.x, c.y, 1, 1);
+            ++m_version;
+        }
+    }
+    return dirty;
 }
 
 void Simulation::setThresholdRandomly()
 {
-    std::uniform_real_distribution<double> distTheta(0.05, 0.6);
+    // Bloki gęstej numeracji z własnymi generatorami, których ziarna bierzemy po kolei z m_rng
+    const std::size_t blockCells = Config::Simulation::seedBlockCells;
+    const std::size_t blocks     = (m_cellCount + blockCells - 1) / blockCells;
 
-    for (auto& cell : m_currentGrid)
+    std::vector<uint32_t> seeds(blocks);
+    for (auto& seed : seeds)
     {
-        cell.threshold = distTheta(m_rng);
+        seed = m_rng();
     }
-    for (std::size_t i = 0; i < m_nextGrid.size(); ++i)
+
+    m_workerPool.forRanges(blocks, seedWorkers(blocks, m_cellCount),
+                           [&](unsigned, std::size_t first, std::size_t last)
+                           {
+                               std::uniform_real_distribution<double> distTheta(0.05, 0.6);
+                               for (std::size_t block = first; block < last; ++block)
+                               {
+                                   std::mt19937_64   rng{seeds[block]};
+                                   const std::size_t end =
+                                       std::min(m_cellCount, (block + 1) * blockCells);
+                                   for (std::size_t i = block * blockCells; i < end; ++i)
+                                   {
+                                       m_currentGrid[i].threshold = distTheta(rng);
+                                       m_nextGrid[i].threshold    = m_currentGrid[i].threshold;
+                                   }
+                               }
+                           });
+    ++m_version;
+}
+
+template <typename ClassOf, typename QuotaFn>
+void Simulation::seedByClass(std::size_t classes, ClassOf classOf, QuotaFn quotas)
+{
+    // Bloki wierszy po ok. seedBlockCells komórek; fn(blok, pierwszy wiersz, koniec)
+    const auto        rows         = static_cast<std::size_t>(m_rows);
+    const std::size_t rowsPerBlock = std::max<std::size_t>(
+        1, Config::Simulation::seedBlockCells / static_cast<std::size_t>(m_cols));
+    const std::size_t blocks  = (rows + rowsPerBlock - 1) / rowsPerBlock;
+    const unsigned    workers = seedWorkers(blocks, m_cellCount);
+
+    auto forEachBlock = [&](auto&& fn)
+    {
+        m_workerPool.forRanges(blocks, workers,
+                               [&](unsigned, std::size_t first, std::size_t last)
+                               {
+                                   for (std::size_t block = first; block < last; ++block)
+                                   {
+                                       const std::size_t y0 = block * rowsPerBlock;
+                                       const std::size_t y1 = std::min(rows, y0 + rowsPerBlock);
+                                       fn(block, static_cast<int>(y0), static_cast<int>(y1));
+                                   }
+                               });
+    };
+
+    // 1. Wolne komórki każdej klasy w każdym bloku: freeCells[blok * classes + klasa]
+    std::vector<std::size_t> freeCells(blocks * classes, 0);
+    forEachBlock(
+        [&](std::size_t block, int yBegin, int yEnd)
+        {
+            std::size_t* counts = freeCells.data() + block * classes;
+            for (int y = yBegin; y < yEnd; ++y)
+            {
+                for (const CellSpan& span : rowSpans(y))
+                {
+                    std::size_t i = span.offset;
+                    for (int x = span.begin; x < span.end; ++x, ++i)
+                    {
+                        if (m_currentGrid[i].side == Side::NONE)
+                        {
+                            ++counts[classOf(x, y, i)];
+                        }
+                    }
+                }
+            }
+        });
+
+    std::vector<std::size_t> capacity(classes, 0);
+    for (std::size_t k = 0; k < freeCells.size(); ++k)
+    {
+        capacity[k % classes] += freeCells[k];
+    }
+    const auto [quotaA, quotaB] = quotas(std::span<const std::size_t>(capacity));
+
+    // 2. Limity klas rozdzielone między bloki, dokładnie co do sztuki
+    std::vector<std::size_t> needA(blocks * classes, 0);
+    std::vector<std::size_t> needB(blocks * classes, 0);
+    std::vector<std::size_t> blockNeed(blocks, 0);
+    for (std::size_t c = 0; c < classes; ++c)
+    {
+        std::size_t pool  = capacity[c];
+        std::size_t leftA = std::min(c < quotaA.size() ? quotaA[c] : 0, pool);
+        std::size_t leftB = std::min(c < quotaB.size() ? quotaB[c] : 0, pool - leftA);
+        for (std::size_t block = 0; block < blocks and leftA + leftB > 0; ++block)
+        {
+            const std::size_t k = block * classes + c;
+            const std::size_t n = freeCells[k];
+            needA[k]            = blockShare(n, leftA, pool, m_rng);
+            needB[k]            = blockShare(n - needA[k], leftB, pool - leftA, m_rng);
+            blockNeed[block] += needA[k] + needB[k];
+            leftA -= needA[k];
+            leftB -= needB[k];
+            pool -= n;
+        }
+    }
+
+    std::vector<uint32_t> seeds(blocks);
+    for (auto& seed : seeds)
     {
-        m_nextGrid[i].threshold = m_currentGrid[i].threshold;
+        seed = m_rng();
     }
+
+    // 3. Losowanie w bloku (algorytm S): wolna komórka klasy c zostaje A z prawdopodobieństwem
+    // needA / wolne, B z needB / wolne, więc na końcu bloku limity są wyczerpane
+    forEachBlock(
+        [&](std::size_t block, int yBegin, int yEnd)
+        {
+            std::size_t  pending = blockNeed[block];
+            std::size_t* left    = freeCells.data() + block * classes;
+            std::size_t* wantA   = needA.data() + block * classes;
+            std::size_t* wantB   = needB.data() + block * classes;
+            std::mt19937 rng{seeds[block]};
+
+            for (int y = yBegin; y < yEnd and pending > 0; ++y)
+            {
+                for (const CellSpan& span : rowSpans(y))
+                {
+                    std::size_t i = span.offset;
+                    for (int x = span.begin; x < span.end; ++x, ++i)
+                    {
+                        CellData& cell = m_currentGrid[i];
+                        if (cell.side not_eq Side::NONE)
+                        {
+                            continue;
+                        }
+
+                        const std::size_t c = classOf(x, y, i);
+                        if (wantA[c] + wantB[c] == 0)
+                        {
+                            --left[c];
+                            continue;
+                        }
+
+                        std::uniform_int_distribution<std::size_t> pick(0, left[c] - 1);
+                        const std::size_t                          r = pick(rng);
+                        --left[c];
+                        if (r < wantA[c] + wantB[c])
+                        {
+                            const bool toA  = r < wantA[c];
+                            cell.side       = toA ? Side::A : Side::B;
+                            cell.hysteresis = 0.0;
+                            --(toA ? wantA[c] : wantB[c]);
+                            --pending;
+                        }
+                    }
+                }
+            }
+        });
+    ++m_version;
 }
 
 void Simulation::seedRandomly(int countA, int countB)
 {
-    std::uniform_int_distribution<int> distX(0, m_cols - 1);
-    std::uniform_int_distribution<int> distY(0, m_rows - 1);
+    seedByClass(
+        1, [](int, int, std::size_t) { return std::size_t{0}; },
+        [&](std::span<const std::size_t>)
+        {
+            return std::pair{std::vector<std::size_t>{seedCount(countA)},
+                             std::vector<std::size_t>{seedCount(countB)}};
+        });
+}
 
-    auto place = [&](Side side, int count)
+void Simulation::seedStateQuotas(std::span<const int> quotaA, std::span<const int> quotaB)
+{
+    auto toQuota = [](std::span<const int> quota)
     {
-        int placed = 0;
-        while (placed < count)
+        std::vector<std::size_t> out(std::min<std::size_t>(quota.size(), 256));
+        for (std::size_t r = 0; r < out.size(); ++r)
+        {
+            out[r] = seedCount(quota[r]);
+        }
+        return out;
+    };
+
+    seedByClass(
+        256, [this](int, int, std::size_t i) { return std::size_t{m_currentGrid[i].stateId}; },
+        [&](std::span<const std::size_t>) { return std::pair{toQuota(quotaA), toQuota(quotaB)}; });
+}
+
+void Simulation::seedGradient(int countA, int countB)
+{
+    const auto cols  = static_cast<std::size_t>(m_cols);
+    const auto bands = std::min(Config::Simulation::seedGradientBands, cols);
+
+    seedByClass(
+        bands, [&](int x, int, std::size_t) { return static_cast<std::size_t>(x) * bands / cols; },
+        [&](std::span<const std::size_t> capacity)
         {
-            int x = distX(m_rng);
-            int y = distY(m_rng);
+            // Gęstość A maleje liniowo z zachodu na wschód, gęstość B rośnie
+            std::vector<double> weightA(bands);
+            std::vector<double> weightB(bands);
+            for (std::size_t b = 0; b < bands; ++b)
+            {
+                const double t = (static_cast<double>(b) + 0.5) / static_cast<double>(bands);
+                weightA[b]     = (1.0 - t) * static_cast<double>(capacity[b]);
+                weightB[b]     = t * static_cast<double>(capacity[b]);
+            }
 
-            CellData& cell = cellAt(x, y);
-            if (not cell.active)
+            auto quotaA = distributeQuota(seedCount(countA), weightA, capacity);
+
+            std::vector<std::size_t> room(bands);
+            for (std::size_t b = 0; b < bands; ++b)
             {
-                continue;
+                room[b] = capacity[b] - quotaA[b];
+            }
+            auto quotaB = distributeQuota(seedCount(countB), weightB, room);
+            return std::pair{std::move(quotaA), std::move(quotaB)};
+        });
+}
+
+void Simulation::seedClustered(int countA, int countB, int clusters)
+{
+    // Wzrost Edena: z frontu plam strony losujemy komórkę, która dostaje stronę i dokłada do
+    // frontu swoich wolnych sąsiadów. Strony rosną na zmianę; gdy front się wyczerpie (plama
+    // zamknięta przez sąsiadów), zaczyna się nowa plama w losowej wolnej komórce.
+    if (m_cellCount == 0)
+    {
+        return;
+    }
+
+    std::size_t freeCount = 0;
+    for (const CellData& cell : m_currentGrid)
+    {
+        freeCount += (cell.side == Side::NONE) ? 1 : 0;
+    }
+
+    std::size_t need[2];
+    need[0]             = std::min(seedCount(countA), freeCount);
+    need[1]             = std::min(seedCount(countB), freeCount - need[0]);
+    const Side sides[2] = {Side::A, Side::B};
+
+    std::vector<uint8_t>                       queued(m_cellCount, 0);
+    std::vector<uint32_t>                      fronts[2];
+    std::uniform_int_distribution<std::size_t> anyCell(0, m_cellCount - 1);
+
+    // Losowa wolna komórka; przy gęsto zajętej siatce po kilku chybieniach szukamy liniowo
+    // od wylosowanego miejsca (wolna komórka na pewno jest, dopóki coś zostało do rozdania)
+    auto pickFree = [&]
+    {
+        std::size_t i = anyCell(m_rng);
+        for (int attempt = 0; attempt < 32; ++attempt, i = anyCell(m_rng))
+        {
+            if (m_currentGrid[i].side == Side::NONE)
+            {
+                return i;
             }
+        }
+        while (m_currentGrid[i].side not_eq Side::NONE)
+        {
+            i = (i + 1 == m_cellCount) ? 0 : i + 1;
+        }
+        return i;
+    };
+
+    for (int s = 0; s < 2; ++s)
+    {
+        const auto centres = std::min(need[s], static_cast<std::size_t>(std::max(1, clusters)));
+        for (std::size_t k = 0; k < centres; ++k)
+        {
+            const std::size_t i = pickFree();
+            queued[i]           = 1;
+            fronts[s].push_back(static_cast<uint32_t>(i));
+        }
+    }
 
-            if (cell.side not_eq Side::NONE)
+    while (need[0] + need[1] > 0)
+    {
+        for (int s = 0; s < 2; ++s)
+        {
+            if (need[s] == 0)
             {
                 continue;
             }
 
-            cell.side       = side;
+            std::vector<uint32_t>& front = fronts[s];
+            std::size_t            i     = m_cellCount;
+            while (not front.empty())
+            {
+                std::uniform_int_distribution<std::size_t> pick(0, front.size() - 1);
+                const std::size_t                          k = pick(m_rng);
+                const uint32_t                             candidate = front[k];
+                front[k] = front.back();
+                front.pop_back();
+                if (m_currentGrid[candidate].side == Side::NONE)
+                {
+                    i = candidate;
+                    break;
+                }
+            }
+            if (i == m_cellCount)
+            {
+                i = pickFree();
+            }
+
+            CellData& cell  = m_currentGrid[i];
+            cell.side       = sides[s];
             cell.hysteresis = 0.0;
-            ++placed;
+            --need[s];
+
+            const int32_t* neighbours = m_neighbours.data() + i * m_neighbourCount;
+            for (std::size_t k = 0; k < m_neighbourCount; ++k)
+            {
+                const int32_t n = neighbours[k];
+                if (n >= 0 and not queued[static_cast<std::size_t>(n)] and
+                    m_currentGrid[static_cast<std::size_t>(n)].side == Side::NONE)
+                {
+                    queued[static_cast<std::size_t>(n)] = 1;
+                    front.push_back(static_cast<uint32_t>(n));
+                }
+            }
+        }
+    }
+    ++m_version;
+}
+
+void Simulation::setSeedPattern(SeedPattern pattern)
+{
+    m_seedPattern = pattern;
+}
+
+void Simulation::seedInitialState()
+{
+    const int countA = Config::Simulation::initialSeedsA;
+    const int countB = Config::Simulation::initialSeedsB;
+
+    switch (m_seedPattern)
+    {
+    case SeedPattern::CLUSTERED:
+        seedClustered(countA, countB, Config::Simulation::seedClusters);
+        break;
+    case SeedPattern::STATE_QUOTA:
+    {
+        // Każdy stan po tyle samo zwolenników; stan za mały na swoją część oddaje resztę
+        // pozostałym. Bez stanów mapy nie ma czego dzielić - zwykłe losowanie.
+        if (m_regionCount == 0)
+        {
+            seedRandomly(countA, countB);
+            break;
         }
-    };
-    place(Side::A, countA);
-    place(Side::B, countB);
 
+        std::vector<std::size_t> capacity(m_regionCells.begin(), m_regionCells.end());
+        const std::vector<double> equal(capacity.size(), 1.0);
+        const auto quotaA = distributeQuota(seedCount(countA), equal, capacity);
+        for (std::size_t r = 0; r < capacity.size(); ++r)
+        {
+            capacity[r] -= quotaA[r];
+        }
+        const auto quotaB = distributeQuota(seedCount(countB), equal, capacity);
+
+        seedStateQuotas(std::vector<int>(quotaA.begin(), quotaA.end()),
+                        std::vector<int>(quotaB.begin(), quotaB.end()));
+        break;
+    }
+    case SeedPattern::GRADIENT:
+        seedGradient(countA, countB);
+        break;
+    default:
+        seedRandomly(countA, countB);
+        break;
+    }
     setThresholdRandomly();
 }
 
@@ -265,36 +1267,76 @@ GlobalSignals Simulation::calculateCampaignImpact(CampaignDiag& outDiag)
     return globalSignals;
 }
 
-float Simulation::calculateNeighbourInfluence(int x, int y) const
+void Simulation::regionGains(const std::vector<float>& weights, RegionGains& out) const
 {
-    float hDM                 = 0.0f;
-    int   count               = 0;
-    auto  accumulateNeighbour = [&](int nx, int ny)
+    // Mnożnik sygnału na komórkę: waga stanu względem średniej ważonej liczbą komórek,
+    // więc suma po komórkach stanów jest taka sama jak przy kampanii ogólnokrajowej
+    double total    = 0.0;
+    double weighted = 0.0;
+    if (weights.size() == static_cast<std::size_t>(m_regionCount))
     {
-        if (nx < 0 or ny < 0 or nx >= m_cols or ny >= m_rows)
+        for (std::size_t r = 0; r < weights.size(); ++r)
         {
-            return;
+            total += m_regionCells[r];
+            weighted += static_cast<double>(std::max(0.0f, weights[r])) * m_regionCells[r];
         }
-        const CellData& neighborCell = m_currentGrid[idx(nx, ny)];
-        if (not neighborCell.active)
+    }
+    if (weighted <= 0.0)
+    {
+        out.fill(1.0f);
+        return;
+    }
+
+    out.fill(0.0f);
+    for (std::size_t r = 0; r < weights.size(); ++r)
+    {
+        const double gain = static_cast<double>(std::max(0.0f, weights[r])) * total / weighted;
+        out[r] = std::min(Config::Simulation::maxTargetGain, static_cast<float>(gain));
+    }
+}
+
+void Simulation::buildSignalTable(const CampaignDiag& diag)
+{
+    // To samo co w calculateCampaignImpact, ale z natężeniem kanałów przemnożonym przez
+    // mnożnik stanu; przy kampanii ogólnokrajowej (mnożnik 1) wychodzą sygnały globalne
+    RegionGains gainA;
+    RegionGains gainB;
+    regionGains(m_allocationA, gainA);
+    regionGains(m_allocationB, gainB);
+
+    const float stockMax = m_parameters.broadcastStockMax;
+    for (std::size_t s = 0; s < m_signalTable.size(); ++s)
+    {
+        GlobalSignals& signals = m_signalTable[s];
+
+        signals.broadcastA = m_parameters.wBroadcast * std::min(diag.stockA * gainA[s], stockMax);
+        signals.broadcastB = m_parameters.wBroadcast * std::min(diag.stockB * gainB[s], stockMax);
+        signals.socialPressure =
+            m_parameters.wSocial * (diag.effA_social * gainA[s] - diag.effB_social * gainB[s]);
+        signals.dmPressure =
+            m_parameters.wDM * (diag.effA_dm * gainA[s] - diag.effB_dm * gainB[s]);
+    }
+}
+
+float Simulation::calculateNeighbourInfluence(std::size_t i) const
+{
+    float hDM   = 0.0f;
+    int   count = 0;
+
+    // Tablica sąsiadów ma kolejność przesunięć sąsiedztwa; -1 = poza siatką albo tło
+    const int32_t* neighbours = m_neighbours.data() + i * m_neighbourCount;
+    for (std::size_t k = 0; k < m_neighbourCount; ++k)
+    {
+        if (neighbours[k] < 0)
         {
-            return;
+            continue;
         }
+        const CellData& neighborCell = m_currentGrid[static_cast<std::size_t>(neighbours[k])];
         if (neighborCell.side not_eq Side::NONE)
         {
             hDM += getSideScalar(neighborCell.side);
             ++count;
         }
-    };
-
-    std::span<const QVector2D> offsets =
-        (m_neighbourhoodType == NeighbourhoodType::MOORE)
-            ? std::span<const QVector2D>(Config::Neighbourhood::MOORE)
-            : std::span<const QVector2D>(Config::Neighbourhood::VN);
-
-    for (const auto& offset : offsets)
-    {
-        accumulateNeighbour(x + static_cast<int>(offset.x()), y + static_cast<int>(offset.y()));
     }
 
     return (count == 0) ? 0.0f : hDM / static_cast<float>(count);
@@ -302,7 +1344,7 @@ float Simulation::calculateNeighbourInfluence(int x, int y) const
 
 float Simulation::calculateSocialInfluence(std::size_t i) const
 {
-    if (i >= m_socialGraph.size())
+    if (i + 1 >= m_socialOffsets.size())
     {
         return 0.0f;
     }
@@ -310,18 +1352,15 @@ float Simulation::calculateSocialInfluence(std::size_t i) const
     float hSocial = 0.0f;
     int   count   = 0;
 
-    for (std::size_t neighbor : m_socialGraph[i])
+    for (uint32_t k = m_socialOffsets[i]; k < m_socialOffsets[i + 1]; ++k)
     {
-        if (not m_currentGrid[neighbor].active)
-        {
-            continue;
-        }
-        if (m_currentGrid[neighbor].side == Side::NONE)
+        const Side side = m_currentGrid[m_socialTargets[k]].side;
+        if (side == Side::NONE)
         {
             continue;
         }
 
-        hSocial += getSideScalar(m_currentGrid[neighbor].side);
+        hSocial += getSideScalar(side);
         ++count;
     }
 
@@ -367,13 +1406,24 @@ void Simulation::applyBroadcastReinforcementForSupporters(const CellData&      c
 
 void Simulation::buildSocialNetwork(float rewiringProb)
 {
-    std::size_t totalCells = static_cast<std::size_t>(m_cols) * static_cast<std::size_t>(m_rows);
-    m_socialGraph.assign(totalCells, {});
+    // Losowania idą w układzie siatki (ta sama sekwencja niezależnie od maski),
+    // a krawędzie zapisujemy w indeksach gęstych
+    const std::size_t    totalCells = gridSize();
+    std::vector<int32_t> denseOf(totalCells, -1);
+    for (int y = 0; y < m_rows; ++y)
+    {
+        for (const CellSpan& span : rowSpans(y))
+        {
+            for (int x = span.begin; x < span.end; ++x)
+            {
+                denseOf[idx(x, y)] = static_cast<int32_t>(span.offset) + (x - span.begin);
+            }
+        }
+    }
+
+    std::vector<std::vector<uint32_t>> links(m_cellCount);
 
-    std::span<const QVector2D> offsets =
-        (m_neighbourhoodType == NeighbourhoodType::MOORE)
-            ? std::span<const QVector2D>(Config::Neighbourhood::MOORE)
-            : std::span<const QVector2D>(Config::Neighbourhood::VN);
+    const auto offsets = neighbourOffsets(m_neighbourhoodType);
 
     std::uniform_real_distribution<float>      dis(0.0f, 1.0f);
     std::uniform_int_distribution<std::size_t> randomCell(0, totalCells - 1);
@@ -388,10 +1438,10 @@ void Simulation::buildSocialNetwork(float rewiringProb)
         return result;
     };
 
-    auto applyRewiringRule = [&](int x, int y, std::size_t i)
+    auto applyRewiringRule = [&](int x, int y, std::size_t cellId, uint32_t i)
     {
         std::size_t neighbourId = idx(x, y);
-        if (not m_currentGrid[neighbourId].active)
+        if (denseOf[neighbourId] < 0)
         {
             return;
         }
@@ -402,42 +1452,48 @@ void Simulation::buildSocialNetwork(float rewiringProb)
             do
             {
                 k = randomCell(m_rng);
-            } while (k == neighbourId or k == i or not m_currentGrid[k].active);
+            } while (k == neighbourId or k == cellId or denseOf[k] < 0);
 
             neighbourId = k;
         }
 
-        if (std::find(m_socialGraph[i].begin(), m_socialGraph[i].end(), neighbourId) ==
-            m_socialGraph[i].end())
+        const auto j = static_cast<uint32_t>(denseOf[neighbourId]);
+        if (std::find(links[i].begin(), links[i].end(), j) == links[i].end())
         {
-            m_socialGraph[i].push_back(neighbourId);
+            links[i].push_back(j);
         }
 
-        if (std::find(m_socialGraph[neighbourId].begin(), m_socialGraph[neighbourId].end(), i) ==
-            m_socialGraph[neighbourId].end())
+        if (std::find(links[j].begin(), links[j].end(), i) == links[j].end())
         {
-            m_socialGraph[neighbourId].push_back(i);
+            links[j].push_back(i);
         }
     };
 
     for (int y = 0; y < m_rows; ++y)
     {
-        for (int x = 0; x < m_cols; ++x)
+        for (const CellSpan& span : rowSpans(y))
         {
-            const std::size_t i = idx(x, y);
-            if (not m_currentGrid[i].active)
-            {
-                continue;
-            }
-
-            for (const auto& offset : offsets)
+            for (int x = span.begin; x < span.end; ++x)
             {
-                const int nx = wrap(x + static_cast<int>(offset.x()), m_cols);
-                const int ny = wrap(y + static_cast<int>(offset.y()), m_rows);
-                applyRewiringRule(nx, ny, i);
+                const auto i = span.offset + static_cast<uint32_t>(x - span.begin);
+                for (const auto& offset : offsets)
+                {
+                    const int nx = wrap(x + static_cast<int>(offset.x()), m_cols);
+                    const int ny = wrap(y + static_cast<int>(offset.y()), m_rows);
+                    applyRewiringRule(nx, ny, idx(x, y), i);
+                }
             }
         }
     }
+
+    // Lista sąsiedztwa -> CSR: jedna ciągła tablica zamiast wektora na komórkę
+    m_socialOffsets.assign(m_cellCount + 1, 0);
+    m_socialTargets.clear();
+    for (std::size_t i = 0; i < m_cellCount; ++i)
+    {
+        m_socialTargets.insert(m_socialTargets.end(), links[i].begin(), links[i].end());
+        m_socialOffsets[i + 1] = static_cast<uint32_t>(m_socialTargets.size());
+    }
 }
 
 inline void Simulation::applyChannelHysteresis(const CellData& currentCell,
@@ -571,10 +1627,6 @@ void Simulation::computeGridSpatialMetrics(const std::vector<CellData>& grid,
 
     auto considerPair = [&](const CellData& a, const CellData& b)
     {
-        if (not a.active or not b.active)
-        {
-            return;
-        }
         if (a.side == Side::NONE or b.side == Side::NONE)
         {
             return;
@@ -590,20 +1642,33 @@ void Simulation::computeGridSpatialMetrics(const std::vector<CellData>& grid,
         }
     };
 
+    // Tylko po odcinkach aktywnych: prawy sąsiad w odcinku jest aktywny z definicji,
+    // a dolnego szukamy, przesuwając się równolegle po odcinkach następnego wiersza
     for (int y = 0; y < m_rows; ++y)
     {
-        for (int x = 0; x < m_cols; ++x)
+        const auto  below = (y + 1 < m_rows) ? rowSpans(y + 1) : std::span<const CellSpan>{};
+        std::size_t b     = 0;
+        for (const CellSpan& span : rowSpans(y))
         {
-            const CellData& c = grid[idx(x, y)];
-
-            if (x + 1 < m_cols)
+            for (int x = span.begin; x < span.end; ++x)
             {
-                considerPair(c, grid[idx(x + 1, y)]);
-            }
-
-            if (y + 1 < m_rows)
-            {
-                considerPair(c, grid[idx(x, y + 1)]);
+                const std::size_t i = span.offset + static_cast<std::size_t>(x - span.begin);
+                const CellData&   c = grid[i];
+
+                if (x + 1 < span.end)
+                {
+                    considerPair(c, grid[i + 1]);
+                }
+
+                while (b < below.size() and below[b].end <= x)
+                {
+                    ++b;
+                }
+                if (b < below.size() and below[b].begin <= x)
+                {
+                    considerPair(c, grid[below[b].offset +
+                                         static_cast<std::size_t>(x - below[b].begin)]);
+                }
             }
         }
     }
@@ -612,6 +1677,84 @@ void Simulation::computeGridSpatialMetrics(const std::vector<CellData>& grid,
     outStats.gridEdgesUnlike = unlike;
 }
 
+void Simulation::updateRows(int yBegin, int yEnd, StepWorker& worker)
+{
+    // Tylko odcinki aktywnych komórek - tło mapy nie kosztuje nic
+    for (int y = yBegin; y < yEnd; ++y)
+    {
+        for (const CellSpan& span : rowSpans(y))
+        {
+            std::size_t i = span.offset;
+            for (int x = span.begin; x < span.end; ++x, ++i)
+            {
+                const CellData& currentCell = m_currentGrid[i];
+                CellData&       nextCell    = m_nextGrid[i];
+
+                // Sygnały kampanii dla stanu komórki (poza mapą i bez celowania: globalne)
+                const GlobalSignals& globalSignals = m_signalTable[currentCell.stateId];
+
+                const float rawDM   = calculateNeighbourInfluence(i);
+                const float totalDM = (rawDM * m_parameters.wLocal) + globalSignals.dmPressure;
+
+                const float rawSocial = calculateSocialInfluence(i);
+                const float totalSocial =
+                    (m_parameters.wSocial * rawSocial) + globalSignals.socialPressure;
+
+                const float perceivedDM =
+                    applyOpenMind(currentCell.side, totalDM, m_parameters.openMindDM);
+                const float perceivedSocial =
+                    applyOpenMind(currentCell.side, totalSocial, m_parameters.openMindSocial);
+
+                const float baseInfluence = perceivedDM + perceivedSocial;
+
+                const float h =
+                    applyBroadcastPersuasionForNeutrals(currentCell, baseInfluence, globalSignals);
+
+                updateCellState(currentCell, nextCell, h);
+
+                // Pole emitujemy w tym samym przebiegu - bez dodatkowej pętli po siatce
+                if (m_captureField)
+                {
+                    m_field[i] = h;
+                }
+                if (nextCell.side not_eq currentCell.side)
+                {
+                    m_lastFlipIteration[i] = m_iteration;
+                    if (m_captureChanges)
+                    {
+                        worker.changes.push_back(static_cast<uint32_t>(idx(x, y) << 2) bitor
+                                                 static_cast<uint32_t>(nextCell.side));
+                    }
+                }
+
+                StepTransitions cellTrans;
+                cellTrans.record(currentCell.side, nextCell.side);
+                updateFlipTracker(i, currentCell.side, nextCell.side, cellTrans);
+
+                applyBroadcastReinforcementForSupporters(currentCell, nextCell, globalSignals);
+
+                applyChannelHysteresis(currentCell, nextCell, perceivedDM, m_parameters.dmHysGain,
+                                       m_parameters.dmHysErode, m_parameters.hysMaxTotal);
+
+                applyChannelHysteresis(currentCell, nextCell, perceivedSocial,
+                                       m_parameters.socialHysGain, m_parameters.socialHysErode,
+                                       m_parameters.hysMaxTotal);
+
+                worker.stats.trans.add(cellTrans);
+                worker.stats.addCell(nextCell);
+
+                // Histogram per stan w tym samym przebiegu; 255 (poza mapą) odpada na porównaniu
+                if (currentCell.stateId < worker.regions.size())
+                {
+                    RegionStats& region = worker.regions[currentCell.stateId];
+                    region.trans.add(cellTrans);
+                    region.addCell(nextCell);
+                }
+            }
+        }
+    }
+}
+
 void Simulation::step()
 {
     StepStats currentStats{};
@@ -619,6 +1762,7 @@ void Simulation::step()
     currentStats.paramsSnapshot = m_parameters;
 
     m_nextGrid = m_currentGrid;
+    m_changedCells.clear();
 
     const GlobalSignals globalSignals = calculateCampaignImpact(currentStats.campaign);
 
@@ -626,52 +1770,45 @@ void Simulation::step()
     currentStats.budgetA  = m_playerA.budget;
     currentStats.budgetB  = m_playerB.budget;
 
-    for (int y = 0; y < m_rows; ++y)
+    buildSignalTable(currentStats.campaign);
+
+    // Komórki liczone są niezależnie (czytają tylko bieżącą siatkę), więc wiersze dzielimy
+    // między wątki; każdy ma własne liczniki, histogram stanów i listę zmian
+    const std::size_t minRows = std::max<std::size_t>(
+        1, Config::Simulation::minCellsPerWorker / static_cast<std::size_t>(m_cols));
+    const unsigned workers = Parallel::workerCount(static_cast<std::size_t>(m_rows), minRows);
+    m_stepWorkers.resize(workers);
+
+    m_workerPool.forRanges(static_cast<std::size_t>(m_rows), workers,
+                           [&](unsigned w, std::size_t rowBegin, std::size_t rowEnd)
+                           {
+                               StepWorker& worker = m_stepWorkers[w];
+                               worker.stats       = {};
+                               worker.regions.assign(static_cast<std::size_t>(m_regionCount), {});
+                               worker.changes.clear();
+                               updateRows(static_cast<int>(rowBegin), static_cast<int>(rowEnd),
+                                          worker);
+                           });
+
+    // Scalanie w kolejności wierszy - lista zmian zostaje posortowana po indeksie
+    m_lastRegionStats.assign(static_cast<std::size_t>(m_regionCount), {});
+    for (unsigned w = 0; w < workers; ++w)
     {
-        for (int x = 0; x < m_cols; ++x)
+        const StepWorker& worker = m_stepWorkers[w];
+        currentStats.addCounts(worker.stats);
+        for (std::size_t r = 0; r < worker.regions.size(); ++r)
         {
-            const std::size_t i           = idx(x, y);
-            const CellData&   currentCell = m_currentGrid[i];
-            CellData&         nextCell    = m_nextGrid[i];
-
-            if (not currentCell.active)
-            {
-                continue;
-            }
-
-            const float rawDM   = calculateNeighbourInfluence(x, y);
-            const float totalDM = (rawDM * m_parameters.wLocal) + globalSignals.dmPressure;
-
-            const float rawSocial = calculateSocialInfluence(i);
-            const float totalSocial =
-                (m_parameters.wSocial * rawSocial) + globalSignals.socialPressure;
-
-            const float perceivedDM =
-                applyOpenMind(currentCell.side, totalDM, m_parameters.openMindDM);
-            const float perceivedSocial =
-                applyOpenMind(currentCell.side, totalSocial, m_parameters.openMindSocial);
-
-            const float baseInfluence = perceivedDM + perceivedSocial;
-
-            const float h =
-                applyBroadcastPersuasionForNeutrals(currentCell, baseInfluence, globalSignals);
-
-            updateCellState(currentCell, nextCell, h);
-
-            currentStats.trans.record(currentCell.side, nextCell.side);
-            updateFlipTracker(i, currentCell.side, nextCell.side, currentStats.trans);
-
-            applyBroadcastReinforcementForSupporters(currentCell, nextCell, globalSignals);
-
-            applyChannelHysteresis(currentCell, nextCell, perceivedDM, m_parameters.dmHysGain,
-                                   m_parameters.dmHysErode, m_parameters.hysMaxTotal);
-
-            applyChannelHysteresis(currentCell, nextCell, perceivedSocial,
-                                   m_parameters.socialHysGain, m_parameters.socialHysErode,
-                                   m_parameters.hysMaxTotal);
-
-            currentStats.addCell(nextCell);
+            m_lastRegionStats[r].add(worker.regions[r]);
         }
+        if (m_captureChanges)
+        {
+            m_changedCells.insert(m_changedCells.end(), worker.changes.begin(),
+                                  worker.changes.end());
+        }
+    }
+    for (auto& region : m_lastRegionStats)
+    {
+        region.finalize();
     }
 
     computeGridSpatialMetrics(m_nextGrid, currentStats);
@@ -703,4 +1840,5 @@ void Simulation::step()
                            << "  hysDecay =" << m_parameters.hysDecay;
     }
     ++m_iteration;
+    ++m_version;
 }
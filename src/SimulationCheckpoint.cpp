@@ -0,0 +1,469 @@
+#include "Simulation.hpp"
+
+#include <QFile>
+#include <QSaveFile>
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+#include <type_traits>
+
+// Format checkpointu (wersja 2, kolejność bajtów hosta zapisana w nagłówku):
+//   Header, tablica SectionEntry[sectionCount], potem sekcje wyrównane do 8 bajtów.
+// Komórki są zapisane jako osobne płaszczyzny (SoA), graf społeczny jako CSR,
+// a struktury POD (parametry, gracze, ostatnie StepStats) wprost. Odczyt mapuje plik
+// i kopiuje płaszczyzny bez parsowania wartości.
+// Płaszczyzny i graf są w pliku w układzie całej siatki (y * cols + x), niezależnie od
+// gęstej numeracji aktywnych komórek w pamięci; tło zapisujemy jako komórki domyślne.
+namespace
+{
+    constexpr char        kMagic[8]      = {'P', 'S', 'C', 'K', 'P', 'T', '\0', '\0'};
+    constexpr uint32_t    kVersion       = 2; // 2: sumy histerezy StepStats w HysSum (int64)
+    constexpr uint32_t    kByteOrderMark = 0x01020304;
+    constexpr std::size_t kAlignment     = 8;
+    constexpr uint32_t    kMaxSections   = 64;
+
+    enum class Section : uint32_t
+    {
+        SIDE = 1,
+        ACTIVE,
+        STATE_ID,
+        THRESHOLD,
+        HYSTERESIS,
+        FLIP_PENDING,
+        FLIP_AGE,
+        LAST_FLIP,
+        GRAPH_OFFSETS,
+        GRAPH_TARGETS,
+        PARAMETERS,
+        PLAYERS,
+        LAST_STATS,
+        RNG_STATE
+    };
+
+    struct Header
+    {
+            char     magic[8];
+            uint32_t version;
+            uint32_t byteOrderMark;
+            int32_t  cols;
+            int32_t  rows;
+            int32_t  iteration;
+            uint8_t  neighbourhood;
+            uint8_t  reserved[3];
+            float    broadcastStockA;
+            float    broadcastStockB;
+            uint32_t sectionCount;
+            uint32_t reserved2;
+    };
+
+    struct SectionEntry
+    {
+            uint32_t id;
+            uint32_t reserved;
+            uint64_t offset;
+            uint64_t size;
+    };
+
+    static_assert(sizeof(Header) == 48);
+    static_assert(sizeof(SectionEntry) == 24);
+    static_assert(std::is_trivially_copyable_v<BaseParameters>);
+    static_assert(std::is_trivially_copyable_v<Player>);
+    static_assert(std::is_trivially_copyable_v<StepStats>);
+
+    struct SectionData
+    {
+            Section     id;
+            const void* data;
+            std::size_t size;
+    };
+
+    std::size_t alignUp(std::size_t value)
+    {
+        return (value + kAlignment - 1) / kAlignment * kAlignment;
+    }
+
+    void setError(QString* errorMessage, const QString& message)
+    {
+        if (errorMessage)
+        {
+            *errorMessage = message;
+        }
+    }
+
+    template <typename T> std::vector<T> copyPlane(const uchar* data, std::size_t count)
+    {
+        std::vector<T> plane(count);
+        std::memcpy(plane.data(), data, count * sizeof(T));
+        return plane;
+    }
+} // namespace
+
+bool Simulation::saveCheckpoint(const QString& path, QString* errorMessage) const
+{
+    const std::size_t n = gridSize();
+
+    // Indeks gęsty -> indeks siatki
+    std::vector<uint64_t> gridIndex(m_cellCount);
+    for (int y = 0; y < m_rows; ++y)
+    {
+        for (const CellSpan& span : rowSpans(y))
+        {
+            for (int x = span.begin; x < span.end; ++x)
+            {
+                gridIndex[span.offset + static_cast<std::size_t>(x - span.begin)] = idx(x, y);
+            }
+        }
+    }
+
+    // Komórki: AoS -> płaszczyzny siatki
+    const CellData       outside{.active = false};
+    std::vector<uint8_t> side(n, static_cast<uint8_t>(outside.side)), active(n, 0), pending(n, 0);
+    std::vector<uint8_t> stateId(n, 255), age(n, 0);
+    std::vector<double>  threshold(n, outside.threshold), hysteresis(n, outside.hysteresis);
+    std::vector<int32_t> lastFlip(n, 0);
+    if (m_stateIds.size() == n)
+    {
+        stateId = m_stateIds;
+    }
+    for (std::size_t d = 0; d < m_cellCount; ++d)
+    {
+        const auto      i    = static_cast<std::size_t>(gridIndex[d]);
+        const CellData& cell = m_currentGrid[d];
+        side[i]              = static_cast<uint8_t>(cell.side);
+        active[i]            = cell.active ? 1 : 0;
+        stateId[i]           = cell.stateId;
+        threshold[i]         = cell.threshold;
+        hysteresis[i]        = cell.hysteresis;
+        pending[i]           = static_cast<uint8_t>(m_flipTracker[d].pendingForm);
+        age[i]               = m_flipTracker[d].age;
+        lastFlip[i]          = m_lastFlipIteration[d];
+    }
+
+    // Graf społeczny: CSR gęsty -> CSR siatki
+    std::vector<uint64_t> graphOffsets(n + 1, 0);
+    std::vector<uint64_t> graphTargets;
+    graphTargets.reserve(m_socialTargets.size());
+    for (std::size_t d = 0; d < m_cellCount; ++d)
+    {
+        graphOffsets[gridIndex[d] + 1] = m_socialOffsets[d + 1] - m_socialOffsets[d];
+    }
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        graphOffsets[i + 1] += graphOffsets[i];
+    }
+    for (std::size_t d = 0; d < m_cellCount; ++d)
+    {
+        for (uint32_t k = m_socialOffsets[d]; k < m_socialOffsets[d + 1]; ++k)
+        {
+            graphTargets.push_back(gridIndex[m_socialTargets[k]]);
+        }
+    }
+
+    const Player players[2] = {m_playerA, m_playerB};
+
+    std::ostringstream rngStream;
+    rngStream << m_rng;
+    const std::string rngState = rngStream.str();
+
+    const std::vector<SectionData> sections = {
+        {Section::SIDE, side.data(), side.size()},
+        {Section::ACTIVE, active.data(), active.size()},
+        {Section::STATE_ID, stateId.data(), stateId.size()},
+        {Section::THRESHOLD, threshold.data(), threshold.size() * sizeof(double)},
+        {Section::HYSTERESIS, hysteresis.data(), hysteresis.size() * sizeof(double)},
+        {Section::FLIP_PENDING, pending.data(), pending.size()},
+        {Section::FLIP_AGE, age.data(), age.size()},
+        {Section::LAST_FLIP, lastFlip.data(), lastFlip.size() * sizeof(int32_t)},
+        {Section::GRAPH_OFFSETS, graphOffsets.data(), graphOffsets.size() * sizeof(uint64_t)},
+        {Section::GRAPH_TARGETS, graphTargets.data(), graphTargets.size() * sizeof(uint64_t)},
+        {Section::PARAMETERS, &m_parameters, sizeof(BaseParameters)},
+        {Section::PLAYERS, players, sizeof(players)},
+        {Section::LAST_STATS, &m_lastStepStats, sizeof(StepStats)},
+        {Section::RNG_STATE, rngState.data(), rngState.size()},
+    };
+
+    Header header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version         = kVersion;
+    header.byteOrderMark   = kByteOrderMark;
+    header.cols            = m_cols;
+    header.rows            = m_rows;
+    header.iteration       = m_iteration;
+    header.neighbourhood   = static_cast<uint8_t>(m_neighbourhoodType);
+    header.broadcastStockA = m_broadcastStockA;
+    header.broadcastStockB = m_broadcastStockB;
+    header.sectionCount    = static_cast<uint32_t>(sections.size());
+
+    std::vector<SectionEntry> table;
+    std::size_t offset = alignUp(sizeof(Header) + sections.size() * sizeof(SectionEntry));
+    for (const auto& section : sections)
+    {
+        table.push_back({static_cast<uint32_t>(section.id), 0, offset, section.size});
+        offset = alignUp(offset + section.size);
+    }
+
+    QSaveFile file(path);
+    if (not file.open(QIODevice::WriteOnly))
+    {
+        setError(errorMessage, "[Checkpoint] Cannot open " + path + ": " + file.errorString());
+        return false;
+    }
+
+    static constexpr char padding[kAlignment] = {};
+    const auto write = [&file](const void* data, std::size_t size)
+    {
+        const auto bytes = static_cast<qint64>(size);
+        return file.write(static_cast<const char*>(data), bytes) == bytes;
+    };
+    const auto pad = [&file, &write]()
+    {
+        const auto pos = static_cast<std::size_t>(file.pos());
+        return write(padding, alignUp(pos) - pos);
+    };
+
+    bool ok = write(&header, sizeof(header)) and
+              write(table.data(), table.size() * sizeof(SectionEntry)) and pad();
+    for (std::size_t s = 0; ok and s < sections.size(); ++s)
+    {
+        ok = write(sections[s].data, sections[s].size) and pad();
+    }
+
+    if (not ok or not file.commit())
+    {
+        setError(errorMessage, "[Checkpoint] Failed to write " + path + ": " + file.errorString());
+        return false;
+    }
+    return true;
+}
+
+bool Simulation::loadCheckpoint(const QString& path, QString* errorMessage)
+{
+    QFile file(path);
+    if (not file.open(QIODevice::ReadOnly))
+    {
+        setError(errorMessage, "[Checkpoint] Cannot open " + path + ": " + file.errorString());
+        return false;
+    }
+
+    const auto   fileSize = static_cast<std::size_t>(file.size());
+    const uchar* data     = file.map(0, file.size());
+    QByteArray   fallback;
+    if (not data)
+    {
+        fallback = file.readAll();
+        data     = reinterpret_cast<const uchar*>(fallback.constData());
+    }
+
+    const auto fail = [&](const QString& reason)
+    {
+        setError(errorMessage, "[Checkpoint] " + path + ": " + reason);
+        return false;
+    };
+
+    Header header{};
+    if (fileSize < sizeof(Header))
+    {
+        return fail("file too small");
+    }
+    std::memcpy(&header, data, sizeof(Header));
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) not_eq 0)
+    {
+        return fail("not a checkpoint file");
+    }
+    if (header.version not_eq kVersion)
+    {
+        return fail(QStringLiteral("unsupported version %1").arg(header.version));
+    }
+    if (header.byteOrderMark not_eq kByteOrderMark)
+    {
+        return fail("written on a machine with different byte order");
+    }
+    if (header.cols not_eq m_cols or header.rows not_eq m_rows)
+    {
+        return fail(QStringLiteral("grid is %1x%2, expected %3x%4")
+                        .arg(header.cols)
+                        .arg(header.rows)
+                        .arg(m_cols)
+                        .arg(m_rows));
+    }
+    if (header.neighbourhood > static_cast<uint8_t>(NeighbourhoodType::MOORE))
+    {
+        return fail("corrupted header");
+    }
+    if (header.sectionCount > kMaxSections or
+        sizeof(Header) + header.sectionCount * sizeof(SectionEntry) > fileSize)
+    {
+        return fail("corrupted section table");
+    }
+
+    std::vector<SectionEntry> table(header.sectionCount);
+    std::memcpy(table.data(), data + sizeof(Header), table.size() * sizeof(SectionEntry));
+
+    // Sekcja o danym id; expectedSize == 0 oznacza dowolny rozmiar
+    const auto find = [&](Section id, std::size_t expectedSize,
+                          std::size_t* outSize = nullptr) -> const uchar*
+    {
+        for (const auto& entry : table)
+        {
+            if (entry.id not_eq static_cast<uint32_t>(id))
+            {
+                continue;
+            }
+            const bool fits = entry.offset <= fileSize and entry.size <= fileSize - entry.offset;
+            if (not fits or (expectedSize not_eq 0 and entry.size not_eq expectedSize))
+            {
+                return nullptr;
+            }
+            if (outSize)
+            {
+                *outSize = static_cast<std::size_t>(entry.size);
+            }
+            return data + entry.offset;
+        }
+        return nullptr;
+    };
+
+    const std::size_t n = gridSize();
+
+    const uchar* side       = find(Section::SIDE, n);
+    const uchar* active     = find(Section::ACTIVE, n);
+    const uchar* stateId    = find(Section::STATE_ID, n);
+    const uchar* threshold  = find(Section::THRESHOLD, n * sizeof(double));
+    const uchar* hysteresis = find(Section::HYSTERESIS, n * sizeof(double));
+    const uchar* pending    = find(Section::FLIP_PENDING, n);
+    const uchar* age        = find(Section::FLIP_AGE, n);
+    const uchar* lastFlip   = find(Section::LAST_FLIP, n * sizeof(int32_t));
+    const uchar* offsets    = find(Section::GRAPH_OFFSETS, (n + 1) * sizeof(uint64_t));
+    const uchar* params     = find(Section::PARAMETERS, sizeof(BaseParameters));
+    const uchar* players    = find(Section::PLAYERS, 2 * sizeof(Player));
+    const uchar* lastStats  = find(Section::LAST_STATS, sizeof(StepStats));
+
+    std::size_t  targetsSize = 0;
+    std::size_t  rngSize     = 0;
+    const uchar* targets     = find(Section::GRAPH_TARGETS, 0, &targetsSize);
+    const uchar* rng         = find(Section::RNG_STATE, 0, &rngSize);
+
+    if (not side or not active or not stateId or not threshold or not hysteresis or not pending or
+        not age or not lastFlip or not offsets or not targets or not params or not players or
+        not lastStats or not rng)
+    {
+        return fail("missing or truncated section");
+    }
+
+    // Graf: CSR -> lista sąsiedztwa, z walidacją indeksów
+    const auto graphOffsets = copyPlane<uint64_t>(offsets, n + 1);
+    const auto graphTargets = copyPlane<uint64_t>(targets, targetsSize / sizeof(uint64_t));
+    if (graphOffsets.front() not_eq 0 or graphOffsets.back() not_eq graphTargets.size() or
+        not std::is_sorted(graphOffsets.begin(), graphOffsets.end()) or
+        std::any_of(graphTargets.begin(), graphTargets.end(), [n](uint64_t t) { return t >= n; }))
+    {
+        return fail("corrupted social graph");
+    }
+
+    std::mt19937       restoredRng;
+    std::istringstream rngStream(std::string(reinterpret_cast<const char*>(rng), rngSize));
+    rngStream >> restoredRng;
+    if (rngStream.fail())
+    {
+        return fail("corrupted RNG state");
+    }
+
+    const auto thresholds   = copyPlane<double>(threshold, n);
+    const auto hystereses   = copyPlane<double>(hysteresis, n);
+    const auto flipIters    = copyPlane<int32_t>(lastFlip, n);
+    const auto isValidSide  = [](uchar v) { return v <= static_cast<uchar>(Side::B); };
+    if (not std::all_of(side, side + n, isValidSide) or
+        not std::all_of(pending, pending + n, isValidSide))
+    {
+        return fail("corrupted cell data");
+    }
+
+    // Wszystko poprawne: dopiero teraz podmieniamy stan. Maska aktywnych komórek z pliku
+    // wyznacza numerację gęstą i zostaje maską przebiegu (reset() i resize() jej używają);
+    // pełna siatka to pusta maska, jak w setActiveMask().
+    std::vector<uint8_t> activePlane(active, active + n);
+    rebuildActiveSpans(activePlane);
+    if (m_cellCount == gridSize())
+    {
+        activePlane.clear();
+    }
+    m_activeMask = std::move(activePlane);
+
+    std::vector<int64_t>     denseOf(n, -1);
+    std::vector<CellData>    grid(m_cellCount);
+    std::vector<FlipTracker> tracker(m_cellCount);
+    std::vector<int>         flipIterations(m_cellCount);
+    for (int y = 0; y < m_rows; ++y)
+    {
+        for (const CellSpan& span : rowSpans(y))
+        {
+            std::size_t d = span.offset;
+            for (std::size_t i = idx(span.begin, y); i < idx(span.end, y); ++i, ++d)
+            {
+                denseOf[i] = static_cast<int64_t>(d);
+
+                grid[d].side       = static_cast<Side>(side[i]);
+                grid[d].stateId    = stateId[i];
+                grid[d].threshold  = thresholds[i];
+                grid[d].hysteresis = hystereses[i];
+
+                tracker[d].pendingForm = static_cast<Side>(pending[i]);
+                tracker[d].age         = age[i];
+                flipIterations[d]      = flipIters[i];
+            }
+        }
+    }
+
+    // Krawędzie do tła i tak byłyby pomijane w kroku, więc ich nie przenosimy
+    std::vector<uint32_t> socialOffsets(m_cellCount + 1, 0);
+    std::vector<uint32_t> socialTargets;
+    for (int y = 0; y < m_rows; ++y)
+    {
+        for (const CellSpan& span : rowSpans(y))
+        {
+            std::size_t d = span.offset;
+            for (std::size_t i = idx(span.begin, y); i < idx(span.end, y); ++i, ++d)
+            {
+                for (uint64_t k = graphOffsets[i]; k < graphOffsets[i + 1]; ++k)
+                {
+                    const int64_t target = denseOf[graphTargets[k]];
+                    if (target >= 0)
+                    {
+                        socialTargets.push_back(static_cast<uint32_t>(target));
+                    }
+                }
+                socialOffsets[d + 1] = static_cast<uint32_t>(socialTargets.size());
+            }
+        }
+    }
+
+    m_currentGrid       = std::move(grid);
+    m_nextGrid          = m_currentGrid;
+    m_flipTracker       = std::move(tracker);
+    m_lastFlipIteration = std::move(flipIterations);
+    m_socialOffsets     = std::move(socialOffsets);
+    m_socialTargets     = std::move(socialTargets);
+    if (m_captureField)
+    {
+        m_field.assign(m_cellCount, 0.0f);
+    }
+
+    Player restoredPlayers[2];
+    std::memcpy(&m_parameters, params, sizeof(BaseParameters));
+    std::memcpy(restoredPlayers, players, sizeof(restoredPlayers));
+    std::memcpy(&m_lastStepStats, lastStats, sizeof(StepStats));
+    m_playerA = restoredPlayers[0];
+    m_playerB = restoredPlayers[1];
+
+    // Statystyk per stan nie ma w pliku - wypełni je następny krok
+    m_lastRegionStats.assign(static_cast<std::size_t>(m_regionCount), {});
+
+    m_iteration         = header.iteration;
+    m_neighbourhoodType = static_cast<NeighbourhoodType>(header.neighbourhood);
+    m_broadcastStockA   = header.broadcastStockA;
+    m_broadcastStockB   = header.broadcastStockB;
+    m_rng               = restoredRng;
+    buildNeighbourTable();
+    ++m_version;
+    return true;
+}
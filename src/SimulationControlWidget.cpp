@@ -58,6 +58,24 @@ SimulationControlWidget::SimulationControlWidget(QWidget* parent) : QWidget(pare
     speedLayout->addWidget(lblFast);
     layout->addLayout(speedLayout);
 
+    auto* turboLayout = new QHBoxLayout();
+    m_turboCheck      = makeWidget<QCheckBox>(
+        this, [](QCheckBox* c) { c->setChecked(false); }, Config::UiText::turbo);
+    m_stepsPerFrameSpin = makeWidget<QSpinBox>(
+        this,
+        [](QSpinBox* s)
+        {
+            s->setRange(0, Config::Timing::turboMaxStepsPerFrame);
+            s->setValue(0);
+            s->setSpecialValueText(Config::UiText::autoSteps);
+            s->setEnabled(false);
+        });
+
+    turboLayout->addWidget(m_turboCheck);
+    turboLayout->addWidget(new QLabel(Config::UiText::stepsPerFrame));
+    turboLayout->addWidget(m_stepsPerFrameSpin, 1);
+    layout->addLayout(turboLayout);
+
     layout->addWidget(new QLabel(Config::UiText::neighbourhood));
     m_neighbourhoodCombo = makeWidget<QComboBox>(
         this,
@@ -71,6 +89,16 @@ SimulationControlWidget::SimulationControlWidget(QWidget* parent) : QWidget(pare
     connect(m_simulationSpeedSlider, &QSlider::valueChanged, this,
             &SimulationControlWidget::speedChanged);
 
+    connect(m_turboCheck, &QCheckBox::toggled, this,
+            [this](bool on)
+            {
+                m_stepsPerFrameSpin->setEnabled(on);
+                m_simulationSpeedSlider->setEnabled(not on);
+                emit turboChanged(on);
+            });
+    connect(m_stepsPerFrameSpin, QOverload<int>::of(&QSpinBox::valueChanged), this,
+            &SimulationControlWidget::stepsPerFrameChanged);
+
     connect(m_neighbourhoodCombo, QOverload<int>::of(&QComboBox::currentIndexChanged), this,
             &SimulationControlWidget::neighbourhoodChanged);
 }
@@ -80,6 +108,16 @@ int SimulationControlWidget::getSpeed() const
     return m_simulationSpeedSlider->value();
 }
 
+bool SimulationControlWidget::isTurbo() const
+{
+    return m_turboCheck->isChecked();
+}
+
+int SimulationControlWidget::getStepsPerFrame() const
+{
+    return m_stepsPerFrameSpin->value();
+}
+
 void SimulationControlWidget::setNeighbourhood(int index)
 {
     if (index < 0 or index >= m_neighbourhoodCombo->count())
@@ -0,0 +1,333 @@
+#include "StatsExporter.hpp"
+
+#include "Constants.hpp"
+#include "StatsSchema.hpp"
+
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QTextStream>
+#include <QtEndian>
+#include <algorithm>
+#include <bit>
+#include <chrono>
+
+namespace
+{
+    template <typename T> void appendLittleEndian(QByteArray& out, T value)
+    {
+        const T le = qToLittleEndian(value);
+        out.append(reinterpret_cast<const char*>(&le), sizeof(le));
+    }
+
+    void appendValue(QByteArray& out, StatsSchema::ColumnType type, double value)
+    {
+        switch (type)
+        {
+        case StatsSchema::ColumnType::INT32:
+            appendLittleEndian(out, static_cast<qint32>(value));
+            break;
+        case StatsSchema::ColumnType::FLOAT32:
+            appendLittleEndian(out, std::bit_cast<quint32>(static_cast<float>(value)));
+            break;
+        case StatsSchema::ColumnType::FLOAT64:
+            appendLittleEndian(out, std::bit_cast<quint64>(value));
+            break;
+        }
+    }
+} // namespace
+
+StatsExporter::~StatsExporter()
+{
+    stop();
+}
+
+bool StatsExporter::start(const QString& path, Format format, QString* errorMessage)
+{
+    stop();
+
+    m_format = format;
+    m_file.setFileName(path);
+
+    QIODevice::OpenMode mode = QIODevice::WriteOnly bitor QIODevice::Truncate;
+    if (format == Format::CSV)
+    {
+        mode |= QIODevice::Text;
+    }
+    if (not m_file.open(mode))
+    {
+        if (errorMessage)
+        {
+            *errorMessage = m_file.errorString();
+        }
+        return false;
+    }
+
+    if (not writeHeader())
+    {
+        if (errorMessage)
+        {
+            *errorMessage = m_file.errorString();
+        }
+        m_file.close();
+        return false;
+    }
+
+    if (not openRegionFile(path, errorMessage))
+    {
+        m_file.close();
+        return false;
+    }
+
+    m_pending.clear();
+    m_stopRequested = false;
+    m_failed        = false;
+    m_running       = true;
+    m_thread        = std::thread([this] { run(); });
+    return true;
+}
+
+void StatsExporter::stop()
+{
+    if (not m_running)
+    {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopRequested = true;
+    }
+    m_wake.notify_one();
+    m_thread.join();
+
+    m_file.close();
+    m_regionFile.close();
+    m_running = false;
+}
+
+void StatsExporter::push(const StepStats& s, const std::vector<RegionStats>& regions)
+{
+    if (not m_running)
+    {
+        return;
+    }
+
+    // Regiony tylko gdy plik per stan jest otwarty, inaczej nie ma po co ich kopiować
+    Row row{s, m_regionFile.isOpen() ? regions : std::vector<RegionStats>{}};
+
+    bool batchReady = false;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_pending.push_back(std::move(row));
+        batchReady = m_pending.size() >= Config::Stats::exportBatchRows;
+    }
+    if (batchReady)
+    {
+        m_wake.notify_one();
+    }
+}
+
+void StatsExporter::setRegionNames(QStringList names)
+{
+    m_regionNames = std::move(names);
+}
+
+bool StatsExporter::openRegionFile(const QString& path, QString* errorMessage)
+{
+    m_writerRegionNames.clear();
+    if (m_regionNames.isEmpty())
+    {
+        return true;
+    }
+
+    const QFileInfo info(path);
+    m_regionFile.setFileName(
+        info.dir().filePath(info.completeBaseName() + QStringLiteral(".states.csv")));
+    if (not m_regionFile.open(QIODevice::WriteOnly bitor QIODevice::Truncate bitor
+                              QIODevice::Text))
+    {
+        if (errorMessage)
+        {
+            *errorMessage = m_regionFile.errorString();
+        }
+        return false;
+    }
+
+    const QByteArray header = StatsSchema::regionCsvHeader().toUtf8() + '\n';
+    if (m_regionFile.write(header) not_eq header.size())
+    {
+        if (errorMessage)
+        {
+            *errorMessage = m_regionFile.errorString();
+        }
+        m_regionFile.close();
+        return false;
+    }
+
+    // Wątek zapisu czyta własną kopię, setRegionNames w trakcie nagrywania jej nie rusza
+    m_writerRegionNames = m_regionNames;
+    return true;
+}
+
+bool StatsExporter::isRunning() const
+{
+    return m_running;
+}
+
+bool StatsExporter::hasFailed() const
+{
+    return m_failed;
+}
+
+bool StatsExporter::writeHeader()
+{
+    QByteArray header;
+    if (m_format == Format::CSV)
+    {
+        header = StatsSchema::csvHeader().toUtf8() + '\n';
+    }
+    else
+    {
+        const auto columns = StatsSchema::columns();
+        const auto params  = StatsSchema::paramColumns();
+
+        header.append(kBinaryMagic, sizeof(kBinaryMagic));
+        appendLittleEndian(header, kBinaryVersion);
+        appendLittleEndian(header, static_cast<quint32>(columns.size() + params.size()));
+
+        const auto appendColumn = [&header](StatsSchema::ColumnType type, const char* name)
+        {
+            const QByteArray bytes(name);
+            header.append(static_cast<char>(type));
+            header.append(static_cast<char>(bytes.size()));
+            header.append(bytes);
+        };
+        for (const auto& column : columns)
+        {
+            appendColumn(column.type, column.name);
+        }
+        for (const auto& param : params)
+        {
+            appendColumn(StatsSchema::ColumnType::FLOAT32, param.name);
+        }
+    }
+
+    return m_file.write(header) == header.size() and m_file.flush();
+}
+
+void StatsExporter::run()
+{
+    const auto flushInterval = std::chrono::milliseconds(Config::Stats::exportFlushIntervalMs);
+
+    QTextStream      csv(&m_file);
+    QTextStream      regionCsv(&m_regionFile);
+    std::vector<Row> batch;
+    for (;;)
+    {
+        bool stopping = false;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait_for(lock, flushInterval,
+                            [this]
+                            {
+                                return m_stopRequested or
+                                       m_pending.size() >= Config::Stats::exportBatchRows;
+                            });
+            batch.swap(m_pending);
+            stopping = m_stopRequested;
+        }
+
+        if (not batch.empty() and not m_failed)
+        {
+            if (m_format == Format::CSV)
+            {
+                writeCsvBatch(csv, batch);
+            }
+            else
+            {
+                writeBinaryBatch(batch);
+            }
+            if (m_regionFile.isOpen())
+            {
+                writeRegionBatch(regionCsv, batch);
+            }
+        }
+        batch.clear();
+
+        if (stopping)
+        {
+            return;
+        }
+    }
+}
+
+void StatsExporter::writeCsvBatch(QTextStream& out, const std::vector<Row>& batch)
+{
+    for (const auto& row : batch)
+    {
+        StatsSchema::writeCsvRow(out, row.stats);
+    }
+    out.flush();
+
+    if (out.status() not_eq QTextStream::Ok)
+    {
+        qWarning() << "StatsExporter: write failed:" << m_file.errorString();
+        m_failed = true;
+    }
+}
+
+void StatsExporter::writeRegionBatch(QTextStream& out, const std::vector<Row>& batch)
+{
+    for (const auto& row : batch)
+    {
+        const std::size_t count =
+            std::min(row.regions.size(), static_cast<std::size_t>(m_writerRegionNames.size()));
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            StatsSchema::writeRegionCsvRow(out, row.stats.iter,
+                                           m_writerRegionNames[static_cast<qsizetype>(i)],
+                                           row.regions[i]);
+        }
+    }
+    out.flush();
+
+    if (out.status() not_eq QTextStream::Ok)
+    {
+        qWarning() << "StatsExporter: write failed:" << m_regionFile.errorString();
+        m_failed = true;
+    }
+}
+
+void StatsExporter::writeBinaryBatch(const std::vector<Row>& batch)
+{
+    const auto columns = StatsSchema::columns();
+    const auto params  = StatsSchema::paramColumns();
+
+    QByteArray block;
+    block.reserve(static_cast<qsizetype>(sizeof(quint32) +
+                                         batch.size() * (columns.size() + params.size()) * 8));
+    appendLittleEndian(block, static_cast<quint32>(batch.size()));
+
+    for (const auto& column : columns)
+    {
+        for (const auto& row : batch)
+        {
+            appendValue(block, column.type, column.get(row.stats));
+        }
+    }
+    for (const auto& param : params)
+    {
+        for (const auto& row : batch)
+        {
+            appendLittleEndian(block,
+                               std::bit_cast<quint32>(row.stats.paramsSnapshot.*param.member));
+        }
+    }
+
+    if (m_file.write(block) not_eq block.size() or not m_file.flush())
+    {
+        qWarning() << "StatsExporter: write failed:" << m_file.errorString();
+        m_failed = true;
+    }
+}
@@ -0,0 +1,250 @@
+#include "StatsHistory.hpp"
+
+#include "StatsSchema.hpp"
+
+#include <QDebug>
+#include <QDir>
+#include <algorithm>
+#include <cstring>
+#include <type_traits>
+
+static_assert(std::is_trivially_copyable_v<BaseParameters>);
+
+namespace
+{
+    void writeValue(std::vector<std::byte>& bytes, StatsSchema::ColumnType type, double value)
+    {
+        const std::size_t offset = bytes.size();
+        bytes.resize(offset + StatsSchema::byteSize(type));
+        std::byte* dst = bytes.data() + offset;
+
+        switch (type)
+        {
+        case StatsSchema::ColumnType::INT32:
+        {
+            const auto v = static_cast<int32_t>(value);
+            std::memcpy(dst, &v, sizeof(v));
+            break;
+        }
+        case StatsSchema::ColumnType::FLOAT32:
+        {
+            const auto v = static_cast<float>(value);
+            std::memcpy(dst, &v, sizeof(v));
+            break;
+        }
+        case StatsSchema::ColumnType::FLOAT64:
+            std::memcpy(dst, &value, sizeof(value));
+            break;
+        }
+    }
+
+    double readValue(const void* src, StatsSchema::ColumnType type)
+    {
+        switch (type)
+        {
+        case StatsSchema::ColumnType::INT32:
+        {
+            int32_t v = 0;
+            std::memcpy(&v, src, sizeof(v));
+            return static_cast<double>(v);
+        }
+        case StatsSchema::ColumnType::FLOAT32:
+        {
+            float v = 0.0f;
+            std::memcpy(&v, src, sizeof(v));
+            return static_cast<double>(v);
+        }
+        case StatsSchema::ColumnType::FLOAT64:
+        {
+            double v = 0.0;
+            std::memcpy(&v, src, sizeof(v));
+            return v;
+        }
+        }
+        return 0.0;
+    }
+} // namespace
+
+StatsHistory::StatsHistory()
+{
+    const auto columns = StatsSchema::columns();
+    for (std::size_t i = 0; i < columns.size(); ++i)
+    {
+        if (columns[i].set)
+        {
+            m_storedColumns.push_back(i);
+            m_columnBytes.push_back(StatsSchema::byteSize(columns[i].type));
+        }
+    }
+}
+
+StatsHistory::~StatsHistory()
+{
+    clear();
+}
+
+void StatsHistory::append(const StepStats& s)
+{
+    if (m_chunks.empty() or m_chunks.back().rows == kChunkRows)
+    {
+        startChunk();
+        spillResidentOverflow();
+    }
+
+    Chunk&     chunk   = m_chunks.back();
+    const auto columns = StatsSchema::columns();
+    for (std::size_t slot = 0; slot < m_storedColumns.size(); ++slot)
+    {
+        const auto& column = columns[m_storedColumns[slot]];
+        writeValue(chunk.columns[slot], column.type, column.get(s));
+    }
+
+    if (m_paramRuns.empty() or std::memcmp(&m_paramRuns.back().params, &s.paramsSnapshot,
+                                           sizeof(BaseParameters)) not_eq 0)
+    {
+        m_paramRuns.push_back({m_size, s.paramsSnapshot});
+    }
+
+    ++chunk.rows;
+    ++m_size;
+}
+
+void StatsHistory::clear()
+{
+    if (m_spillFile)
+    {
+        for (auto& chunk : m_chunks)
+        {
+            if (chunk.spilled and not chunk.mapped.empty())
+            {
+                m_spillFile->unmap(const_cast<uchar*>(chunk.mapped.front()));
+            }
+        }
+        m_spillFile.reset();
+    }
+
+    m_chunks.clear();
+    m_paramRuns.clear();
+    m_size          = 0;
+    m_firstResident = 0;
+    m_spillFailed   = false;
+}
+
+std::size_t StatsHistory::size() const
+{
+    return m_size;
+}
+
+bool StatsHistory::empty() const
+{
+    return m_size == 0;
+}
+
+StepStats StatsHistory::row(std::size_t index) const
+{
+    const Chunk&      chunk   = m_chunks[index / kChunkRows];
+    const std::size_t r       = index % kChunkRows;
+    const auto        columns = StatsSchema::columns();
+
+    StepStats s{};
+    for (std::size_t slot = 0; slot < m_storedColumns.size(); ++slot)
+    {
+        const auto& column = columns[m_storedColumns[slot]];
+        column.set(s, readValue(cell(chunk, slot, r), column.type));
+    }
+    s.paramsSnapshot = paramsAt(index);
+    return s;
+}
+
+const BaseParameters& StatsHistory::paramsAt(std::size_t index) const
+{
+    // Ostatnia seria zaczynająca się nie później niż index
+    auto it = std::upper_bound(m_paramRuns.begin(), m_paramRuns.end(), index,
+                               [](std::size_t row, const ParamRun& run)
+                               { return row < run.firstRow; });
+    return std::prev(it)->params;
+}
+
+void StatsHistory::startChunk()
+{
+    Chunk chunk;
+    chunk.columns.resize(m_storedColumns.size());
+    for (std::size_t slot = 0; slot < chunk.columns.size(); ++slot)
+    {
+        chunk.columns[slot].reserve(kChunkRows * m_columnBytes[slot]);
+    }
+    m_chunks.push_back(std::move(chunk));
+}
+
+void StatsHistory::spillResidentOverflow()
+{
+    // Ostatnia porcja jest właśnie zapełniana, więc nie liczy się do limitu
+    while (not m_spillFailed and m_chunks.size() - 1 - m_firstResident > kMaxResidentChunks)
+    {
+        if (not spillChunk(m_chunks[m_firstResident]))
+        {
+            qWarning() << "StatsHistory: spill to disk failed, keeping history in memory";
+            m_spillFailed = true;
+            return;
+        }
+        ++m_firstResident;
+    }
+}
+
+bool StatsHistory::spillChunk(Chunk& chunk)
+{
+    if (not m_spillFile)
+    {
+        m_spillFile =
+            std::make_unique<QTemporaryFile>(QDir::tempPath() + "/propaganda-stats-XXXXXX.bin");
+        if (not m_spillFile->open())
+        {
+            m_spillFile.reset();
+            return false;
+        }
+    }
+
+    const qint64 offset = m_spillFile->size();
+    if (not m_spillFile->seek(offset))
+    {
+        return false;
+    }
+
+    qint64 total = 0;
+    for (const auto& bytes : chunk.columns)
+    {
+        const auto size = static_cast<qint64>(bytes.size());
+        if (m_spillFile->write(reinterpret_cast<const char*>(bytes.data()), size) not_eq size)
+        {
+            return false;
+        }
+        total += size;
+    }
+    m_spillFile->flush();
+
+    const uchar* base = m_spillFile->map(offset, total);
+    if (not base)
+    {
+        return false;
+    }
+
+    chunk.mapped.resize(chunk.columns.size());
+    for (std::size_t slot = 0; slot < chunk.columns.size(); ++slot)
+    {
+        chunk.mapped[slot] = base;
+        base += chunk.columns[slot].size();
+        std::vector<std::byte>().swap(chunk.columns[slot]);
+    }
+    chunk.spilled = true;
+    return true;
+}
+
+const void* StatsHistory::cell(const Chunk& chunk, std::size_t slot, std::size_t r) const
+{
+    const std::size_t offset = r * m_columnBytes[slot];
+    if (chunk.spilled)
+    {
+        return chunk.mapped[slot] + offset;
+    }
+    return chunk.columns[slot].data() + offset;
+}
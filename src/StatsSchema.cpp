@@ -0,0 +1,157 @@
+#include "StatsSchema.hpp"
+
+#include <QTextStream>
+#include <array>
+
+namespace
+{
+    using StatsSchema::Column;
+    using StatsSchema::ColumnType;
+    using StatsSchema::ParamColumn;
+
+// Pole StepStats zapisywane i odtwarzane przez kolumnę
+#define STATS_FIELD(name, type, field)                                                             \
+    Column                                                                                         \
+    {                                                                                              \
+        name, ColumnType::type, [](const StepStats& s) { return static_cast<double>(s.field); },   \
+            [](StepStats& s, double v) { s.field = static_cast<decltype(s.field)>(v); }            \
+    }
+
+    // clang-format off
+    const std::array kColumns = {
+        STATS_FIELD("iter", INT32, iter),
+        STATS_FIELD("active", INT32, active),
+        STATS_FIELD("countA", INT32, countA),
+        STATS_FIELD("countB", INT32, countB),
+        STATS_FIELD("countN", INT32, countN),
+        STATS_FIELD("shareA", FLOAT64, shareA),
+        STATS_FIELD("shareB", FLOAT64, shareB),
+        STATS_FIELD("shareN", FLOAT64, shareN),
+        STATS_FIELD("avgHysA", FLOAT64, avgHysA),
+        STATS_FIELD("avgHysB", FLOAT64, avgHysB),
+        STATS_FIELD("N_to_A", INT32, trans.N_to_A),
+        STATS_FIELD("N_to_B", INT32, trans.N_to_B),
+        STATS_FIELD("A_to_NONE", INT32, trans.A_to_NONE),
+        STATS_FIELD("B_to_NONE", INT32, trans.B_to_NONE),
+        STATS_FIELD("A_to_B", INT32, trans.A_to_B),
+        STATS_FIELD("B_to_A", INT32, trans.B_to_A),
+        STATS_FIELD("budgetA", FLOAT32, budgetA),
+        STATS_FIELD("budgetB", FLOAT32, budgetB),
+        STATS_FIELD("plannedCostA", FLOAT32, campaign.plannedCostA),
+        STATS_FIELD("plannedCostB", FLOAT32, campaign.plannedCostB),
+        STATS_FIELD("scaleA", FLOAT32, campaign.scaleA),
+        STATS_FIELD("scaleB", FLOAT32, campaign.scaleB),
+        STATS_FIELD("spentA", FLOAT32, campaign.spentA),
+        STATS_FIELD("spentB", FLOAT32, campaign.spentB),
+        STATS_FIELD("ctrlA_broadcast", FLOAT32, campaign.ctrlA_broadcast_sum),
+        STATS_FIELD("ctrlB_broadcast", FLOAT32, campaign.ctrlB_broadcast_sum),
+        STATS_FIELD("ctrlA_dm", FLOAT32, campaign.ctrlA_dm_sum),
+        STATS_FIELD("ctrlB_dm", FLOAT32, campaign.ctrlB_dm_sum),
+        STATS_FIELD("ctrlA_social", FLOAT32, campaign.ctrlA_social_sum),
+        STATS_FIELD("ctrlB_social", FLOAT32, campaign.ctrlB_social_sum),
+        STATS_FIELD("effA_broadcast", FLOAT32, campaign.effA_broadcast),
+        STATS_FIELD("effB_broadcast", FLOAT32, campaign.effB_broadcast),
+        STATS_FIELD("effA_dm", FLOAT32, campaign.effA_dm),
+        STATS_FIELD("effB_dm", FLOAT32, campaign.effB_dm),
+        STATS_FIELD("effA_social", FLOAT32, campaign.effA_social),
+        STATS_FIELD("effB_social", FLOAT32, campaign.effB_social),
+        STATS_FIELD("stockA", FLOAT32, campaign.stockA),
+        STATS_FIELD("stockB", FLOAT32, campaign.stockB),
+        STATS_FIELD("broadcastA", FLOAT32, gSignals.broadcastA),
+        STATS_FIELD("broadcastB", FLOAT32, gSignals.broadcastB),
+        Column{"broadcastBias", ColumnType::FLOAT32,
+               [](const StepStats& s) { return static_cast<double>(s.gSignals.broadcastBias()); },
+               nullptr},
+        STATS_FIELD("dmPressure", FLOAT32, gSignals.dmPressure),
+        STATS_FIELD("socialPressure", FLOAT32, gSignals.socialPressure),
+        STATS_FIELD("gridEdgesLike", INT32, gridEdgesLike),
+        STATS_FIELD("gridEdgesUnlike", INT32, gridEdgesUnlike),
+        STATS_FIELD("gridEdgesTotal", INT32, gridEdgesTotal),
+        STATS_FIELD("localHomophily", FLOAT64, localHomophily),
+        STATS_FIELD("boundaryRate", FLOAT64, boundaryRate),
+    };
+    // clang-format on
+
+#undef STATS_FIELD
+
+    const std::array kParamColumns = {
+        ParamColumn{"wLocal", &BaseParameters::wLocal},
+        ParamColumn{"thetaScale", &BaseParameters::thetaScale},
+        ParamColumn{"margin", &BaseParameters::margin},
+        ParamColumn{"wDM", &BaseParameters::wDM},
+        ParamColumn{"wBroadcast", &BaseParameters::wBroadcast},
+        ParamColumn{"wSocial", &BaseParameters::wSocial},
+        ParamColumn{"switchKappa", &BaseParameters::switchKappa},
+        ParamColumn{"hysDecay", &BaseParameters::hysDecay},
+        ParamColumn{"hysMaxTotal", &BaseParameters::hysMaxTotal},
+        ParamColumn{"broadcastDecay", &BaseParameters::broadcastDecay},
+        ParamColumn{"broadcastStockMax", &BaseParameters::broadcastStockMax},
+        ParamColumn{"broadcastHysGain", &BaseParameters::broadcastHysGain},
+        ParamColumn{"broadcastNeutralWeight", &BaseParameters::broadcastNeutralWeight},
+    };
+} // namespace
+
+std::span<const Column> StatsSchema::columns()
+{
+    return kColumns;
+}
+
+std::span<const ParamColumn> StatsSchema::paramColumns()
+{
+    return kParamColumns;
+}
+
+QString StatsSchema::csvHeader()
+{
+    QString header;
+    for (const auto& column : columns())
+    {
+        header += QString::fromLatin1(column.name) + ',';
+    }
+    for (const auto& param : paramColumns())
+    {
+        header += QString::fromLatin1(param.name) + ',';
+    }
+    header.chop(1);
+    return header;
+}
+
+void StatsSchema::writeCsvRow(QTextStream& out, const StepStats& s)
+{
+    for (const auto& column : columns())
+    {
+        const double v = column.get(s);
+        if (column.type == ColumnType::INT32)
+        {
+            out << static_cast<int>(v) << ",";
+        }
+        else
+        {
+            out << v << ",";
+        }
+    }
+
+    const auto params = paramColumns();
+    for (std::size_t p = 0; p < params.size(); ++p)
+    {
+        out << s.paramsSnapshot.*params[p].member << (p + 1 < params.size() ? "," : "\n");
+    }
+}
+
+QString StatsSchema::regionCsvHeader()
+{
+    return QStringLiteral("iter,state,active,countA,countB,countN,shareA,shareB,shareN,avgHysA,"
+                          "avgHysB,N_to_A,N_to_B,A_to_NONE,B_to_NONE,A_to_B,B_to_A");
+}
+
+void StatsSchema::writeRegionCsvRow(QTextStream&       out,
+                                    int                iter,
+                                    const QString&     region,
+                                    const RegionStats& r)
+{
+    out << iter << ',' << region << ',' << r.active << ',' << r.countA << ',' << r.countB << ','
+        << r.countN << ',' << r.shareA << ',' << r.shareB << ',' << r.shareN << ',' << r.avgHysA
+        << ',' << r.avgHysB << ',' << r.trans.N_to_A << ',' << r.trans.N_to_B << ','
+        << r.trans.A_to_NONE << ',' << r.trans.B_to_NONE << ',' << r.trans.A_to_B << ','
+        << r.trans.B_to_A << '\n';
+}
@@ -1,9 +1,12 @@
 #include "StatsWidget.hpp"
 
 #include "Simulation.hpp"
+#include "StatsSchema.hpp"
 
+#include <QHeaderView>
 #include <algorithm>
 #include <qnamespace.h>
+#include <utility>
 
 using namespace app::ui;
 
@@ -25,16 +28,36 @@ StatsWidget::StatsWidget(QWidget* parent) : QWidget(parent)
     m_header     = new QLabel("Stats: N/A", this);
     m_header->setStyleSheet("font-weight: bold;");
 
-    m_saveBtn  = new QPushButton("Save CSV", this);
-    m_clearBtn = new QPushButton("Clear", this);
+    m_saveBtn   = new QPushButton("Save CSV", this);
+    m_recordBtn = new QPushButton(Config::UiText::recordStats, this);
+    m_clearBtn  = new QPushButton("Clear", this);
+
+    m_windowCombo = new QComboBox(this);
+    for (const int window : Config::Stats::chartWindows)
+    {
+        m_windowCombo->addItem(window > 0 ? Config::UiText::chartWindowLast.arg(window)
+                                          : Config::UiText::chartWindowAll,
+                               window);
+    }
 
     topRow->addWidget(m_header, 1);
+    topRow->addWidget(new QLabel(Config::UiText::chartWindow, this), 0);
+    topRow->addWidget(m_windowCombo, 0);
     topRow->addWidget(m_saveBtn, 0);
+    topRow->addWidget(m_recordBtn, 0);
     topRow->addWidget(m_clearBtn, 0);
     root->addLayout(topRow);
 
     connect(m_saveBtn, &QPushButton::clicked, this, [this] { saveCsv(); });
+    connect(m_recordBtn, &QPushButton::clicked, this, [this] { toggleRecording(); });
     connect(m_clearBtn, &QPushButton::clicked, this, [this] { clear(); });
+    connect(m_windowCombo, QOverload<int>::of(&QComboBox::currentIndexChanged), this,
+            [this](int index)
+            {
+                m_window      = m_windowCombo->itemData(index).toInt();
+                m_chartsDirty = not m_buffers[kPopA].points.empty();
+                flushCharts();
+            });
 
     // --- Chart 1: poparcie ---
     auto* popChart = new QChart();
@@ -133,7 +156,60 @@ StatsWidget::StatsWidget(QWidget* parent) : QWidget(parent)
 
     m_sigView = makeChartView(sigChart, this);
 
-    // Layout wykresów: 2 + 1
+    // --- Statystyki per stan: tabela ostatniego kroku + udziały zaznaczonego stanu ---
+    m_regionTable = new QTableWidget(0, 10, this);
+    m_regionTable->setHorizontalHeaderLabels(
+        {"State", "Name", "Active", "A %", "B %", "NONE %", "Hys A", "Hys B", "N->A", "N->B"});
+    m_regionTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_regionTable->setSelectionBehavior(QAbstractItemView::SelectRows);
+    m_regionTable->setSelectionMode(QAbstractItemView::SingleSelection);
+    m_regionTable->verticalHeader()->setVisible(false);
+    m_regionTable->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+    connect(m_regionTable, &QTableWidget::currentCellChanged, this,
+            [this](int row)
+            {
+                m_selectedRegion = row;
+                flushRegionChart();
+            });
+
+    auto* regionChart = new QChart();
+    regionChart->setTitle("State share (A / B / NONE)");
+    regionChart->legend()->setVisible(true);
+
+    m_regionA = new QLineSeries();
+    m_regionA->setName("A");
+    m_regionA->setColor(Qt::red);
+    m_regionB = new QLineSeries();
+    m_regionB->setName("B");
+    m_regionB->setColor(Qt::blue);
+    m_regionN = new QLineSeries();
+    m_regionN->setName("NONE");
+
+    regionChart->addSeries(m_regionA);
+    regionChart->addSeries(m_regionB);
+    regionChart->addSeries(m_regionN);
+
+    m_regionX = new QValueAxis();
+    m_regionX->setTitleText("Iteration");
+    m_regionY = new QValueAxis();
+    m_regionY->setTitleText("Share");
+    m_regionY->setRange(0.0, 1.0);
+
+    regionChart->addAxis(m_regionX, Qt::AlignBottom);
+    regionChart->addAxis(m_regionY, Qt::AlignLeft);
+    for (auto* series : {m_regionA, m_regionB, m_regionN})
+    {
+        series->attachAxis(m_regionX);
+        series->attachAxis(m_regionY);
+    }
+
+    m_regionView = makeChartView(regionChart, this);
+
+    // Bez mapy nie ma regionów - setRegions() pokaże oba widżety
+    m_regionTable->setVisible(false);
+    m_regionView->setVisible(false);
+
+    // Layout wykresów: 2 + 1 (+ tabela i wykres stanów)
     auto* grid = new QGridLayout();
     grid->setContentsMargins(0, 0, 0, 0);
     grid->setHorizontalSpacing(8);
@@ -142,17 +218,271 @@ StatsWidget::StatsWidget(QWidget* parent) : QWidget(parent)
     grid->addWidget(m_popView, 0, 0, 1, 2);
     grid->addWidget(m_budgetView, 1, 0, 1, 1);
     grid->addWidget(m_sigView, 1, 1, 1, 1);
+    grid->addWidget(m_regionTable, 2, 0, 1, 1);
+    grid->addWidget(m_regionView, 2, 1, 1, 1);
 
     root->addLayout(grid, 1);
 
+    bindSeries(kPopA, m_popA);
+    bindSeries(kPopB, m_popB);
+    bindSeries(kPopN, m_popN);
+    bindSeries(kBudgetA, m_budgetA);
+    bindSeries(kBudgetB, m_budgetB);
+    bindSeries(kBroadcastBias, m_broadcastBias);
+    bindSeries(kDmPressure, m_dmPressure);
+    bindSeries(kSocialPressure, m_socialPressure);
+
+    m_refreshTimer = new QTimer(this);
+    m_refreshTimer->setInterval(Config::Stats::refreshIntervalMs);
+    connect(m_refreshTimer, &QTimer::timeout, this, [this] { flushCharts(); });
+    m_refreshTimer->start();
+
     clear();
 }
 
+void StatsWidget::bindSeries(SeriesIndex index, QLineSeries* series)
+{
+    auto& buffer  = m_buffers[index];
+    buffer.series = series;
+    buffer.points.reset(static_cast<std::size_t>(m_maxPoints));
+    buffer.max.setWindow(static_cast<std::size_t>(m_maxPoints));
+    buffer.min.setWindow(static_cast<std::size_t>(m_maxPoints));
+
+    auto& live = m_liveBuffers[index];
+    live.points.reset(static_cast<std::size_t>(m_maxPoints));
+    live.max.setWindow(static_cast<std::size_t>(m_maxPoints));
+    live.min.setWindow(static_cast<std::size_t>(m_maxPoints));
+}
+
+void StatsWidget::appendPoint(SeriesIndex index, int iter, double value)
+{
+    auto& buffer = m_buffers[index];
+    buffer.points.push(QPointF(iter, value));
+    buffer.max.push(value);
+    buffer.min.push(value);
+    buffer.history.push(iter, value);
+}
+
+void StatsWidget::flushCharts()
+{
+    // Niewidoczne wykresy nie muszą się przeliczać; showEvent dogoni stan
+    if (not m_chartsDirty or not isVisible())
+    {
+        return;
+    }
+
+    Extents extents{};
+    int     minX = 0;
+
+    if (m_window == m_maxPoints)
+    {
+        flushLiveWindow(extents, minX);
+    }
+    else
+    {
+        flushHistoryWindow(extents, minX);
+    }
+
+    updateAxesRanges(minX, m_lastSample.iter, extents);
+    updateHeader(m_lastSample);
+    flushRegions();
+    m_chartsDirty = false;
+}
+
+void StatsWidget::flushRegions()
+{
+    if (m_lastRegions.empty())
+    {
+        return;
+    }
+
+    const auto setCell = [this](int row, int column, const QString& text)
+    { m_regionTable->item(row, column)->setText(text); };
+
+    for (std::size_t i = 0; i < m_lastRegions.size(); ++i)
+    {
+        const auto& r   = m_lastRegions[i];
+        const int   row = static_cast<int>(i);
+        setCell(row, 2, QString::number(r.active));
+        setCell(row, 3, QString::number(r.shareA * 100.0, 'f', 2));
+        setCell(row, 4, QString::number(r.shareB * 100.0, 'f', 2));
+        setCell(row, 5, QString::number(r.shareN * 100.0, 'f', 2));
+        setCell(row, 6, QString::number(r.avgHysA, 'f', 3));
+        setCell(row, 7, QString::number(r.avgHysB, 'f', 3));
+        setCell(row, 8, QString::number(r.trans.N_to_A));
+        setCell(row, 9, QString::number(r.trans.N_to_B));
+    }
+
+    flushRegionChart();
+}
+
+void StatsWidget::flushRegionChart()
+{
+    if (m_selectedRegion < 0 or m_selectedRegion >= static_cast<int>(m_regionSeries.size()))
+    {
+        m_regionA->clear();
+        m_regionB->clear();
+        m_regionN->clear();
+        return;
+    }
+
+    const auto&    buffers = m_regionSeries[static_cast<std::size_t>(m_selectedRegion)];
+    QList<QPointF> points;
+    const auto     replace = [&points](QLineSeries* series, const RingBuffer<QPointF>& buffer)
+    {
+        points.clear();
+        points.reserve(static_cast<qsizetype>(buffer.size()));
+        buffer.appendTo(points);
+        series->replace(points);
+    };
+    replace(m_regionA, buffers.a);
+    replace(m_regionB, buffers.b);
+    replace(m_regionN, buffers.n);
+
+    if (not buffers.a.empty())
+    {
+        m_regionX->setRange(buffers.a.front().x(), buffers.a.back().x());
+    }
+    m_regionView->chart()->setTitle(
+        QString("State share (A / B / NONE): %1").arg(m_regionCodes.value(m_selectedRegion)));
+}
+
+void StatsWidget::setRegions(const QStringList& codes, const QStringList& names)
+{
+    m_regionCodes = codes;
+    m_regionSeries.assign(static_cast<std::size_t>(codes.size()), {});
+    for (auto& series : m_regionSeries)
+    {
+        for (auto* buffer : {&series.a, &series.b, &series.n})
+        {
+            buffer->reset(static_cast<std::size_t>(m_maxPoints));
+        }
+    }
+
+    m_regionTable->clearContents();
+    m_regionTable->setRowCount(static_cast<int>(codes.size()));
+    for (int row = 0; row < m_regionTable->rowCount(); ++row)
+    {
+        m_regionTable->setItem(row, 0, new QTableWidgetItem(codes[row]));
+        m_regionTable->setItem(row, 1, new QTableWidgetItem(names.value(row)));
+        for (int column = 2; column < m_regionTable->columnCount(); ++column)
+        {
+            auto* item = new QTableWidgetItem();
+            item->setTextAlignment(Qt::AlignRight bitor Qt::AlignVCenter);
+            m_regionTable->setItem(row, column, item);
+        }
+    }
+    m_selectedRegion = -1;
+
+    const bool hasRegions = not codes.isEmpty();
+    m_regionTable->setVisible(hasRegions);
+    m_regionView->setVisible(hasRegions);
+
+    // Kody stanów są krótkie i bez przecinków, więc trafiają prosto do CSV
+    m_exporter.setRegionNames(codes);
+    clearRegions();
+}
+
+void StatsWidget::clearRegions()
+{
+    m_lastRegions.clear();
+    for (auto& series : m_regionSeries)
+    {
+        series.a.clear();
+        series.b.clear();
+        series.n.clear();
+    }
+    for (int row = 0; row < m_regionTable->rowCount(); ++row)
+    {
+        for (int column = 2; column < m_regionTable->columnCount(); ++column)
+        {
+            m_regionTable->item(row, column)->setText({});
+        }
+    }
+
+    m_regionA->clear();
+    m_regionB->clear();
+    m_regionN->clear();
+    m_regionX->setRange(0, 100);
+}
+
+void StatsWidget::flushLiveWindow(Extents& extents, int& minX)
+{
+    // Okno = pojemność buforów: surowe punkty, ekstrema z kolejek monotonicznych
+    QList<QPointF> points;
+    for (std::size_t i = 0; i < kSeriesCount; ++i)
+    {
+        auto& buffer = m_buffers[i];
+        points.clear();
+        points.reserve(static_cast<qsizetype>(buffer.points.size()));
+        buffer.points.appendTo(points);
+        buffer.series->replace(points);
+
+        extents[i] = Extent{buffer.min.value(), buffer.max.value()};
+    }
+
+    const auto& window    = m_buffers[kPopA].points;
+    const int   firstIter = window.empty() ? 0 : static_cast<int>(window.front().x());
+    minX                  = std::max(firstIter, m_lastSample.iter - (m_maxPoints - 1));
+}
+
+void StatsWidget::flushHistoryWindow(Extents& extents, int& minX)
+{
+    // Dłuższe okna: zapytanie do magazynu LTTB, O(punkty na ekranie)
+    const auto&  history = m_buffers[kPopA].history;
+    const double lastX   = static_cast<double>(m_lastSample.iter);
+    const double firstX  = history.firstX();
+    const double xMin =
+        (m_window > 0) ? std::max(firstX, lastX - static_cast<double>(m_window - 1)) : firstX;
+
+    const auto target = static_cast<std::size_t>(m_maxPoints);
+
+    QList<QPointF> points;
+    for (std::size_t i = 0; i < kSeriesCount; ++i)
+    {
+        auto&      buffer  = m_buffers[i];
+        const auto sampled = buffer.history.query(xMin, lastX, target);
+
+        points.clear();
+        points.reserve(static_cast<qsizetype>(sampled.size()));
+        Extent extent{sampled.empty() ? 0.0 : sampled.front().y,
+                      sampled.empty() ? 0.0 : sampled.front().y};
+        for (const auto& p : sampled)
+        {
+            points.append(QPointF(p.x, p.y));
+            extent.min = std::min(extent.min, p.y);
+            extent.max = std::max(extent.max, p.y);
+        }
+        buffer.series->replace(points);
+        extents[i] = extent;
+    }
+
+    minX = static_cast<int>(xMin);
+}
+
+void StatsWidget::showEvent(QShowEvent* event)
+{
+    QWidget::showEvent(event);
+    flushCharts();
+}
+
 void StatsWidget::clear()
 {
-    m_samples.clear();
-    m_allSamples.clear();
+    m_history.clear();
+
+    clearBuffers(m_buffers);
+    clearBuffers(m_liveBuffers);
+    m_chartsDirty = false;
+    m_lastSample  = {};
+    m_liveSample  = {};
+    m_replaying   = false;
 
+    resetChartViews();
+    clearRegions();
+}
+
+void StatsWidget::resetChartViews()
+{
     m_popA->clear();
     m_popB->clear();
     m_popN->clear();
@@ -174,80 +504,130 @@ void StatsWidget::clear()
     m_header->setText("Stats: (empty)");
 }
 
-void StatsWidget::pushSample(const StepStats& s)
+void StatsWidget::pushSample(const StepStats& s, const std::vector<RegionStats>& regions)
 {
-    m_allSamples.push_back(s);
-    m_samples.push_back(s);
+    m_history.append(s);
+    m_exporter.push(s, regions);
+
+    appendSample(s);
 
     const int it = s.iter;
+    if (regions.size() == m_regionSeries.size())
+    {
+        for (std::size_t i = 0; i < regions.size(); ++i)
+        {
+            m_regionSeries[i].a.push(QPointF(it, regions[i].shareA));
+            m_regionSeries[i].b.push(QPointF(it, regions[i].shareB));
+            m_regionSeries[i].n.push(QPointF(it, regions[i].shareN));
+        }
+        m_lastRegions = regions;
+    }
 
-    m_popA->append(it, s.shareA);
-    m_popB->append(it, s.shareB);
-    m_popN->append(it, s.shareN);
+    // Wykresy i nagłówek odświeża timer (flushCharts), nie każdy krok
+    m_lastSample  = s;
+    m_chartsDirty = true;
+}
 
-    m_budgetA->append(it, static_cast<double>(s.budgetA));
-    m_budgetB->append(it, static_cast<double>(s.budgetB));
+void StatsWidget::appendSample(const StepStats& s)
+{
+    const int it = s.iter;
+
+    appendPoint(kPopA, it, s.shareA);
+    appendPoint(kPopB, it, s.shareB);
+    appendPoint(kPopN, it, s.shareN);
 
-    m_broadcastBias->append(it, static_cast<double>(s.gSignals.broadcastBias()));
-    m_dmPressure->append(it, static_cast<double>(s.gSignals.dmPressure));
-    m_socialPressure->append(it, static_cast<double>(s.gSignals.socialPressure));
+    appendPoint(kBudgetA, it, static_cast<double>(s.budgetA));
+    appendPoint(kBudgetB, it, static_cast<double>(s.budgetB));
 
-    trimToMaxPoints();
-    updateAxesRanges(it);
-    updateHeader(s);
+    appendPoint(kBroadcastBias, it, static_cast<double>(s.gSignals.broadcastBias()));
+    appendPoint(kDmPressure, it, static_cast<double>(s.gSignals.dmPressure));
+    appendPoint(kSocialPressure, it, static_cast<double>(s.gSignals.socialPressure));
 }
 
-void StatsWidget::trimToMaxPoints()
+void StatsWidget::clearBuffers(std::array<SeriesBuffer, kSeriesCount>& buffers)
 {
-    while (static_cast<int>(m_samples.size()) > m_maxPoints)
+    for (auto& buffer : buffers)
     {
-        m_samples.pop_front();
+        buffer.points.clear();
+        buffer.max.clear();
+        buffer.min.clear();
+        buffer.history.clear();
     }
+}
 
-    auto trimSeries = [&](QLineSeries* ser)
+void StatsWidget::swapLiveBuffers()
+{
+    // Serie Qt zostają na miejscu, zamieniane są tylko punkty i ich ekstrema
+    for (std::size_t i = 0; i < kSeriesCount; ++i)
     {
-        const int extra = ser->count() - m_maxPoints;
-        if (extra > 0)
-        {
-            ser->removePoints(0, extra);
-        }
-    };
+        std::swap(m_buffers[i].points, m_liveBuffers[i].points);
+        std::swap(m_buffers[i].max, m_liveBuffers[i].max);
+        std::swap(m_buffers[i].min, m_liveBuffers[i].min);
+        std::swap(m_buffers[i].history, m_liveBuffers[i].history);
+    }
+}
 
-    trimSeries(m_popA);
-    trimSeries(m_popB);
-    trimSeries(m_popN);
-    trimSeries(m_budgetA);
-    trimSeries(m_budgetB);
-    trimSeries(m_broadcastBias);
-    trimSeries(m_dmPressure);
-    trimSeries(m_socialPressure);
+void StatsWidget::showReplay(const std::vector<StepStats>& samples)
+{
+    if (not m_replaying)
+    {
+        swapLiveBuffers();
+        m_liveSample = m_lastSample;
+        m_replaying  = true;
+    }
+
+    clearBuffers(m_buffers);
+    for (const auto& s : samples)
+    {
+        appendSample(s);
+    }
+
+    m_lastSample  = samples.empty() ? StepStats{} : samples.back();
+    m_chartsDirty = not samples.empty();
+    if (samples.empty())
+    {
+        resetChartViews();
+    }
+    flushCharts();
 }
 
-void StatsWidget::updateAxesRanges(int lastIter)
+void StatsWidget::closeReplay()
 {
-    const int firstIter = (m_samples.empty() ? 0 : m_samples.front().iter);
-    const int minX      = std::max(firstIter, lastIter - (m_maxPoints - 1));
+    if (not m_replaying)
+    {
+        return;
+    }
+
+    swapLiveBuffers();
+    clearBuffers(m_liveBuffers);
+    m_lastSample = m_liveSample;
+    m_replaying  = false;
 
+    m_chartsDirty = not m_buffers[kPopA].points.empty();
+    if (not m_chartsDirty)
+    {
+        resetChartViews();
+    }
+    flushCharts();
+}
+
+void StatsWidget::updateAxesRanges(int minX, int lastIter, const Extents& extents)
+{
     m_popX->setRange(minX, lastIter);
     m_budgetX->setRange(minX, lastIter);
     m_sigX->setRange(minX, lastIter);
 
-    // budżet Y: auto-range z próbek
-    float maxBud = 1.0;
-    for (const auto& s : m_samples)
-    {
-        maxBud = std::max({maxBud, s.budgetA, s.budgetB});
-    }
-    m_budgetY->setRange(0.0, static_cast<double>(maxBud) * 1.05);
+    // budżet Y: auto-range z ekstremów okna
+    const double maxBud = std::max({1.0, extents[kBudgetA].max, extents[kBudgetB].max});
+    m_budgetY->setRange(0.0, maxBud * 1.05);
 
-    // sygnały Y: auto-range
-    float maxSig = 1.0;
-    for (const auto& s : m_samples)
+    // sygnały Y: auto-range symetryczny, |x| = max(max, -min)
+    double maxSig = 1.0;
+    for (const SeriesIndex index : {kBroadcastBias, kDmPressure, kSocialPressure})
     {
-        maxSig = std::max({maxSig, std::abs(s.gSignals.broadcastBias()),
-                           std::abs(s.gSignals.dmPressure), std::abs(s.gSignals.socialPressure)});
+        maxSig = std::max({maxSig, extents[index].max, -extents[index].min});
     }
-    m_sigY->setRange(static_cast<double>(-maxSig) * 1.05, static_cast<double>(maxSig) * 1.05);
+    m_sigY->setRange(-maxSig * 1.05, maxSig * 1.05);
 }
 
 void StatsWidget::updateHeader(const StepStats& s)
@@ -279,51 +659,44 @@ void StatsWidget::saveCsv()
     }
 
     QTextStream out(&f);
-    out << "iter,active,countA,countB,countN,shareA,shareB,shareN,"
-           "avgHysA,avgHysB,"
-           "N_to_A,N_to_B,A_to_NONE,B_to_NONE,A_to_B,B_to_A,"
-           "budgetA,budgetB,plannedCostA,plannedCostB,scaleA,scaleB,spentA,spentB,"
-           "ctrlA_broadcast,ctrlB_broadcast,ctrlA_dm,ctrlB_dm,ctrlA_social,ctrlB_social,"
-           "effA_broadcast,effB_broadcast,effA_dm,effB_dm,effA_social,effB_social,"
-           "stockA,stockB,broadcastA,broadcastB,broadcastBias,dmPressure,socialPressure,"
-           "gridEdgesLike,gridEdgesUnlike,gridEdgesTotal,localHomophily,boundaryRate,"
-           "wLocal,thetaScale,margin,wDM,wBroadcast,wSocial,switchKappa,hysDecay,hysMaxTotal,"
-           "broadcastDecay,broadcastStockMax,broadcastHysGain,broadcastNeutralWeight\n";
-
-    for (const auto& s : m_allSamples)
+    out << StatsSchema::csvHeader() << "\n";
+    for (std::size_t i = 0; i < m_history.size(); ++i)
+    {
+        StatsSchema::writeCsvRow(out, m_history.row(i));
+    }
+}
+
+void StatsWidget::toggleRecording()
+{
+    if (m_exporter.isRunning())
     {
-        out << s.iter << "," << s.active << "," << s.countA << "," << s.countB << "," << s.countN
-            << "," << s.shareA << "," << s.shareB << "," << s.shareN << "," << s.avgHysA << ","
-            << s.avgHysB
-
-            << "," << s.trans.N_to_A << "," << s.trans.N_to_B << "," << s.trans.A_to_NONE << ","
-            << s.trans.B_to_NONE << "," << s.trans.A_to_B << "," << s.trans.B_to_A
-
-            << "," << s.budgetA << "," << s.budgetB << "," << s.campaign.plannedCostA << ","
-            << s.campaign.plannedCostB << "," << s.campaign.scaleA << "," << s.campaign.scaleB
-            << "," << s.campaign.spentA << "," << s.campaign.spentB
-
-            << "," << s.campaign.ctrlA_broadcast_sum << "," << s.campaign.ctrlB_broadcast_sum << ","
-            << s.campaign.ctrlA_dm_sum << "," << s.campaign.ctrlB_dm_sum << ","
-            << s.campaign.ctrlA_social_sum << "," << s.campaign.ctrlB_social_sum
-
-            << "," << s.campaign.effA_broadcast << "," << s.campaign.effB_broadcast << ","
-            << s.campaign.effA_dm << "," << s.campaign.effB_dm << "," << s.campaign.effA_social
-            << "," << s.campaign.effB_social
-
-            << "," << s.campaign.stockA << "," << s.campaign.stockB << "," << s.gSignals.broadcastA
-            << "," << s.gSignals.broadcastB << "," << s.gSignals.broadcastBias() << ","
-            << s.gSignals.dmPressure << "," << s.gSignals.socialPressure
-
-            << "," << s.gridEdgesLike << "," << s.gridEdgesUnlike << "," << s.gridEdgesTotal << ","
-            << s.localHomophily << "," << s.boundaryRate
-
-            << "," << s.paramsSnapshot.wLocal << "," << s.paramsSnapshot.thetaScale << ","
-            << s.paramsSnapshot.margin << "," << s.paramsSnapshot.wDM << ","
-            << s.paramsSnapshot.wBroadcast << "," << s.paramsSnapshot.wSocial << ","
-            << s.paramsSnapshot.switchKappa << "," << s.paramsSnapshot.hysDecay << ","
-            << s.paramsSnapshot.hysMaxTotal << "," << s.paramsSnapshot.broadcastDecay << ","
-            << s.paramsSnapshot.broadcastStockMax << "," << s.paramsSnapshot.broadcastHysGain << ","
-            << s.paramsSnapshot.broadcastNeutralWeight << "\n";
+        m_exporter.stop();
+        m_recordBtn->setText(Config::UiText::recordStats);
+        if (m_exporter.hasFailed())
+        {
+            QMessageBox::warning(this, "Record stats", "Writing the stats file failed.");
+        }
+        return;
+    }
+
+    QString       selectedFilter;
+    const QString path = QFileDialog::getSaveFileName(
+        this, "Record stats", "stats.csv",
+        Config::UiText::recordFilterCsv + ";;" + Config::UiText::recordFilterBin, &selectedFilter);
+    if (path.isEmpty())
+    {
+        return;
+    }
+
+    const bool binary = selectedFilter == Config::UiText::recordFilterBin or
+                        path.endsWith(".pstats", Qt::CaseInsensitive);
+    const auto format = binary ? StatsExporter::Format::BINARY : StatsExporter::Format::CSV;
+
+    QString error;
+    if (not m_exporter.start(path, format, &error))
+    {
+        QMessageBox::warning(this, "Record stats", error);
+        return;
     }
+    m_recordBtn->setText(Config::UiText::stopRecording);
 }
@@ -0,0 +1,253 @@
+#include "TimeSeriesStore.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    using Point = TimeSeriesStore::Point;
+
+    double triangleArea(const Point& a, const Point& b, const Point& c)
+    {
+        return std::abs((a.x - c.x) * (b.y - a.y) - (a.x - b.x) * (c.y - a.y)) * 0.5;
+    }
+
+    Point average(const std::vector<Point>& points)
+    {
+        Point avg;
+        for (const Point& p : points)
+        {
+            avg.x += p.x;
+            avg.y += p.y;
+        }
+        const double n = static_cast<double>(points.size());
+        avg.x /= n;
+        avg.y /= n;
+        return avg;
+    }
+
+    auto lowerByX(const std::deque<Point>& points, double x)
+    {
+        return std::lower_bound(points.begin(), points.end(), x,
+                                [](const Point& p, double value) { return p.x < value; });
+    }
+
+    auto upperByX(const std::deque<Point>& points, double x)
+    {
+        return std::upper_bound(points.begin(), points.end(), x,
+                                [](double value, const Point& p) { return value < p.x; });
+    }
+} // namespace
+
+TimeSeriesStore::TimeSeriesStore(std::size_t levelCapacity) : m_levelCapacity(levelCapacity)
+{
+    // Bez realokacji: pushToLevel trzyma referencje do poziomów przy rekurencji
+    m_levels.reserve(kMaxLevels);
+    m_levels.emplace_back();
+}
+
+void TimeSeriesStore::push(double x, double y)
+{
+    pushToLevel(0, Point{x, y});
+}
+
+void TimeSeriesStore::clear()
+{
+    m_levels.clear();
+    m_levels.emplace_back();
+}
+
+bool TimeSeriesStore::empty() const
+{
+    return m_levels.front().points.empty();
+}
+
+double TimeSeriesStore::firstX() const
+{
+    double first = lastX();
+    for (const Level& level : m_levels)
+    {
+        if (not level.points.empty())
+        {
+            first = std::min(first, level.points.front().x);
+        }
+    }
+    return first;
+}
+
+double TimeSeriesStore::lastX() const
+{
+    const auto& raw = m_levels.front().points;
+    return raw.empty() ? 0.0 : raw.back().x;
+}
+
+void TimeSeriesStore::pushToLevel(std::size_t level, const Point& p)
+{
+    if (level >= m_levels.size())
+    {
+        m_levels.emplace_back();
+    }
+
+    Level& l = m_levels[level];
+    l.points.push_back(p);
+    if (l.points.size() > m_levelCapacity)
+    {
+        l.points.pop_front();
+        l.trimmed = true;
+    }
+
+    if (level + 1 >= kMaxLevels)
+    {
+        return;
+    }
+
+    l.filling.push_back(p);
+    if (l.filling.size() < kBucketSize)
+    {
+        return;
+    }
+
+    if (not l.pending.empty())
+    {
+        // LTTB: z kubełka wybieramy punkt o największym trójkącie
+        // (poprzednio wybrany punkt, kandydat, średnia następnego kubełka)
+        const Point  anchor = l.hasSelected ? l.lastSelected : l.pending.front();
+        const Point  next   = average(l.filling);
+        const Point* best   = &l.pending.front();
+        double       maxA   = -1.0;
+        for (const Point& candidate : l.pending)
+        {
+            const double area = triangleArea(anchor, candidate, next);
+            if (area > maxA)
+            {
+                maxA = area;
+                best = &candidate;
+            }
+        }
+
+        l.lastSelected = *best;
+        l.hasSelected  = true;
+        pushToLevel(level + 1, l.lastSelected);
+    }
+
+    l.pending.swap(l.filling);
+    l.filling.clear();
+}
+
+std::size_t
+TimeSeriesStore::chooseLevel(double xMin, double xMax, std::size_t targetPoints) const
+{
+    // Najdrobniejszy poziom, który sięga xMin i ma w oknie najwyżej ~4x punktów docelowych
+    const std::size_t budget = 4 * std::max<std::size_t>(targetPoints, 1);
+
+    for (std::size_t level = 0; level < m_levels.size(); ++level)
+    {
+        const auto& points = m_levels[level].points;
+        if (points.empty())
+        {
+            break;
+        }
+
+        const bool covers = not m_levels[level].trimmed or points.front().x <= xMin or
+                            level + 1 == m_levels.size();
+        const auto count =
+            static_cast<std::size_t>(upperByX(points, xMax) - lowerByX(points, xMin));
+
+        if (covers and count <= budget)
+        {
+            return level;
+        }
+    }
+
+    return m_levels.empty() ? 0 : m_levels.size() - 1;
+}
+
+std::vector<TimeSeriesStore::Point>
+TimeSeriesStore::query(double xMin, double xMax, std::size_t targetPoints) const
+{
+    std::vector<Point> gathered;
+    if (empty() or xMax < xMin)
+    {
+        return gathered;
+    }
+
+    const std::size_t chosen = chooseLevel(xMin, xMax, targetPoints);
+
+    // Grubszy poziom jest opóźniony o niepełne kubełki - ogon dobieramy z drobniejszych
+    double lastTaken = xMin - 1.0;
+    for (std::size_t level = chosen + 1; level-- > 0;)
+    {
+        const auto& points = m_levels[level].points;
+        const bool  first  = (level == chosen);
+        auto        it     = first ? lowerByX(points, xMin) : upperByX(points, lastTaken);
+        const auto  end    = upperByX(points, xMax);
+
+        for (; it < end; ++it)
+        {
+            gathered.push_back(*it);
+        }
+        if (not gathered.empty())
+        {
+            lastTaken = gathered.back().x;
+        }
+    }
+
+    return lttb(gathered, targetPoints);
+}
+
+std::vector<TimeSeriesStore::Point> TimeSeriesStore::lttb(const std::vector<Point>& data,
+                                                          std::size_t               threshold)
+{
+    const std::size_t n = data.size();
+    if (threshold >= n or threshold < 3)
+    {
+        return data;
+    }
+
+    std::vector<Point> sampled;
+    sampled.reserve(threshold);
+    sampled.push_back(data.front());
+
+    const double every = static_cast<double>(n - 2) / static_cast<double>(threshold - 2);
+    std::size_t  a     = 0;
+
+    auto bucketStart = [every](std::size_t i)
+    { return static_cast<std::size_t>(std::floor(static_cast<double>(i) * every)) + 1; };
+
+    for (std::size_t i = 0; i < threshold - 2; ++i)
+    {
+        const std::size_t avgStart = bucketStart(i + 1);
+        const std::size_t avgEnd   = std::min(bucketStart(i + 2), n);
+
+        Point avg;
+        for (std::size_t j = avgStart; j < avgEnd; ++j)
+        {
+            avg.x += data[j].x;
+            avg.y += data[j].y;
+        }
+        const double avgCount = static_cast<double>(std::max<std::size_t>(avgEnd - avgStart, 1));
+        avg.x /= avgCount;
+        avg.y /= avgCount;
+
+        const std::size_t rangeStart = bucketStart(i);
+        const std::size_t rangeEnd   = std::min(bucketStart(i + 1), n - 1);
+
+        std::size_t best = rangeStart;
+        double      maxA = -1.0;
+        for (std::size_t j = rangeStart; j < rangeEnd; ++j)
+        {
+            const double area = triangleArea(data[a], data[j], avg);
+            if (area > maxA)
+            {
+                maxA = area;
+                best = j;
+            }
+        }
+
+        sampled.push_back(data[best]);
+        a = best;
+    }
+
+    sampled.push_back(data.back());
+    return sampled;
+}
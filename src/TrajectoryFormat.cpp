@@ -0,0 +1,105 @@
+#include "TrajectoryFormat.hpp"
+
+#include "Types.hpp"
+
+namespace
+{
+    constexpr uint64_t kMaxSide = static_cast<uint64_t>(Side::B);
+
+    void appendVarint(QByteArray& out, uint64_t value)
+    {
+        while (value >= 0x80)
+        {
+            out.append(static_cast<char>((value bitand 0x7F) bitor 0x80));
+            value >>= 7;
+        }
+        out.append(static_cast<char>(value));
+    }
+
+    bool readVarint(const uchar*& cursor, const uchar* end, uint64_t& value)
+    {
+        value     = 0;
+        int shift = 0;
+        while (cursor < end and shift < 64)
+        {
+            const uchar byte = *cursor++;
+            value |= static_cast<uint64_t>(byte bitand 0x7F) << shift;
+            if ((byte bitand 0x80) == 0)
+            {
+                return true;
+            }
+            shift += 7;
+        }
+        return false;
+    }
+} // namespace
+
+QByteArray Trajectory::encodeDelta(const std::vector<uint32_t>& changes)
+{
+    QByteArray out;
+    out.reserve(static_cast<qsizetype>(changes.size() * 2));
+
+    uint32_t previous = 0;
+    for (const uint32_t change : changes)
+    {
+        const uint32_t index = changeIndex(change);
+        const uint64_t gap   = index - previous;
+        appendVarint(out, (gap << 2) bitor changeSide(change));
+        previous = index;
+    }
+    return out;
+}
+
+bool Trajectory::applyDelta(const QByteArray& raw, std::vector<uint8_t>& sides)
+{
+    const auto* cursor = reinterpret_cast<const uchar*>(raw.constData());
+    const auto* end    = cursor + raw.size();
+
+    uint64_t index = 0;
+    while (cursor < end)
+    {
+        uint64_t value = 0;
+        if (not readVarint(cursor, end, value))
+        {
+            return false;
+        }
+
+        index += value >> 2;
+        if (index >= sides.size() or (value bitand 0x3u) > kMaxSide)
+        {
+            return false;
+        }
+        sides[index] = static_cast<uint8_t>(value bitand 0x3u);
+    }
+    return true;
+}
+
+QByteArray Trajectory::encodeKeyframe(const std::vector<uint8_t>& sides)
+{
+    QByteArray out(static_cast<qsizetype>((sides.size() + 3) / 4), '\0');
+    auto*      packed = reinterpret_cast<uchar*>(out.data());
+    for (std::size_t i = 0; i < sides.size(); ++i)
+    {
+        packed[i / 4] |= static_cast<uchar>((sides[i] bitand 0x3u) << ((i % 4) * 2));
+    }
+    return out;
+}
+
+bool Trajectory::decodeKeyframe(const QByteArray& raw, std::vector<uint8_t>& sides)
+{
+    if (static_cast<std::size_t>(raw.size()) not_eq (sides.size() + 3) / 4)
+    {
+        return false;
+    }
+
+    const auto* packed = reinterpret_cast<const uchar*>(raw.constData());
+    for (std::size_t i = 0; i < sides.size(); ++i)
+    {
+        sides[i] = static_cast<uint8_t>((packed[i / 4] >> ((i % 4) * 2)) bitand 0x3u);
+        if (sides[i] > kMaxSide)
+        {
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,281 @@
+#include "TrajectoryReader.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+    void setError(QString* errorMessage, const QString& message)
+    {
+        if (errorMessage)
+        {
+            *errorMessage = message;
+        }
+    }
+} // namespace
+
+bool TrajectoryReader::open(const QString& path, QString* errorMessage)
+{
+    close();
+
+    m_file.setFileName(path);
+    if (not m_file.open(QIODevice::ReadOnly))
+    {
+        setError(errorMessage, "[Replay] Cannot open " + path + ": " + m_file.errorString());
+        return false;
+    }
+
+    m_size = static_cast<uint64_t>(m_file.size());
+    m_data = m_file.map(0, m_file.size());
+    if (not m_data)
+    {
+        m_fallback = m_file.readAll();
+        m_data     = reinterpret_cast<const uchar*>(m_fallback.constData());
+    }
+
+    const auto fail = [&](const QString& reason)
+    {
+        setError(errorMessage, "[Replay] " + path + ": " + reason);
+        close();
+        return false;
+    };
+
+    if (m_size < sizeof(Trajectory::FileHeader))
+    {
+        return fail("file too small");
+    }
+    std::memcpy(&m_header, m_data, sizeof(m_header));
+    if (std::memcmp(m_header.magic, Trajectory::kMagic, sizeof(m_header.magic)) not_eq 0)
+    {
+        return fail("not a trajectory file");
+    }
+    if (m_header.version not_eq Trajectory::kVersion or
+        m_header.byteOrderMark not_eq Trajectory::kByteOrderMark)
+    {
+        return fail("unsupported version or byte order");
+    }
+    if (m_header.cols <= 0 or m_header.rows <= 0)
+    {
+        return fail("corrupted header");
+    }
+
+    if (not readIndex())
+    {
+        scanRecords();
+    }
+    if (m_records.empty() or m_keyframes.empty())
+    {
+        return fail("no records");
+    }
+
+    const std::size_t cellCount =
+        static_cast<std::size_t>(m_header.cols) * static_cast<std::size_t>(m_header.rows);
+    m_sides.assign(cellCount, 0);
+    if (not seek(m_records.front().iteration, errorMessage))
+    {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void TrajectoryReader::close()
+{
+    if (m_file.isOpen())
+    {
+        m_file.close(); // zamknięcie zwalnia też mapowanie
+    }
+    m_fallback.clear();
+    m_data   = nullptr;
+    m_size   = 0;
+    m_header = {};
+    m_records.clear();
+    m_keyframes.clear();
+    m_sides.clear();
+    m_position = -1;
+}
+
+bool TrajectoryReader::isOpen() const
+{
+    return m_data not_eq nullptr;
+}
+
+int TrajectoryReader::cols() const
+{
+    return m_header.cols;
+}
+
+int TrajectoryReader::rows() const
+{
+    return m_header.rows;
+}
+
+const std::vector<TrajectoryReader::Record>& TrajectoryReader::records() const
+{
+    return m_records;
+}
+
+bool TrajectoryReader::seek(int iteration, QString* errorMessage)
+{
+    if (m_records.empty())
+    {
+        return false;
+    }
+
+    // Ostatni rekord o iteracji <= iteration (iteracje rosną)
+    auto it = std::upper_bound(m_records.begin(), m_records.end(), iteration,
+                               [](int value, const Record& r) { return value < r.iteration; });
+    const std::size_t target =
+        (it == m_records.begin()) ? 0 : static_cast<std::size_t>(it - m_records.begin()) - 1;
+
+    auto keyIt = std::upper_bound(m_keyframes.begin(), m_keyframes.end(), target);
+    if (keyIt == m_keyframes.begin())
+    {
+        setError(errorMessage, "[Replay] no keyframe before iteration " +
+                                   QString::number(iteration));
+        return false;
+    }
+    const std::size_t keyframe = *std::prev(keyIt);
+
+    // Do przodu od bieżącej pozycji, jeśli nie trzeba wracać do keyframe
+    std::size_t from = keyframe;
+    if (m_position >= static_cast<std::ptrdiff_t>(keyframe) and
+        m_position <= static_cast<std::ptrdiff_t>(target))
+    {
+        from = static_cast<std::size_t>(m_position) + 1;
+    }
+
+    for (std::size_t i = from; i <= target; ++i)
+    {
+        if (not applyRecord(i))
+        {
+            m_position = -1;
+            setError(errorMessage, "[Replay] corrupted record at iteration " +
+                                       QString::number(m_records[i].iteration));
+            return false;
+        }
+        m_position = static_cast<std::ptrdiff_t>(i);
+    }
+    return true;
+}
+
+int TrajectoryReader::currentIteration() const
+{
+    return (m_position >= 0) ? m_records[static_cast<std::size_t>(m_position)].iteration : 0;
+}
+
+const std::vector<uint8_t>& TrajectoryReader::sides() const
+{
+    return m_sides;
+}
+
+bool TrajectoryReader::readIndex()
+{
+    const uint64_t dataStart = sizeof(Trajectory::FileHeader);
+    if (m_size < dataStart + sizeof(Trajectory::IndexFooter))
+    {
+        return false;
+    }
+
+    Trajectory::IndexFooter footer{};
+    std::memcpy(&footer, m_data + m_size - sizeof(footer), sizeof(footer));
+    if (std::memcmp(footer.magic, Trajectory::kIndexMagic, sizeof(footer.magic)) not_eq 0)
+    {
+        return false;
+    }
+
+    const uint64_t indexEnd = m_size - sizeof(footer);
+    if (footer.indexOffset < dataStart or footer.indexOffset > indexEnd or
+        footer.count not_eq (indexEnd - footer.indexOffset) / sizeof(Trajectory::IndexEntry))
+    {
+        return false;
+    }
+
+    std::vector<Record> records(footer.count);
+    for (uint64_t i = 0; i < footer.count; ++i)
+    {
+        Trajectory::IndexEntry entry{};
+        std::memcpy(&entry, m_data + footer.indexOffset + i * sizeof(entry), sizeof(entry));
+        if (entry.offset >= footer.indexOffset or not readRecordAt(entry.offset, records[i]))
+        {
+            return false;
+        }
+    }
+
+    m_records = std::move(records);
+    for (std::size_t i = 0; i < m_records.size(); ++i)
+    {
+        if (m_records[i].type == Trajectory::RecordType::KEYFRAME)
+        {
+            m_keyframes.push_back(i);
+        }
+    }
+    return true;
+}
+
+void TrajectoryReader::scanRecords()
+{
+    m_records.clear();
+    m_keyframes.clear();
+
+    uint64_t offset = sizeof(Trajectory::FileHeader);
+    Record   record;
+    while (readRecordAt(offset, record))
+    {
+        if (not m_records.empty() and record.iteration <= m_records.back().iteration)
+        {
+            break;
+        }
+        if (record.type == Trajectory::RecordType::KEYFRAME)
+        {
+            m_keyframes.push_back(m_records.size());
+        }
+        m_records.push_back(record);
+        offset = record.offset + record.payloadSize;
+    }
+}
+
+bool TrajectoryReader::readRecordAt(uint64_t headerOffset, Record& out) const
+{
+    if (headerOffset > m_size or m_size - headerOffset < sizeof(Trajectory::RecordHeader))
+    {
+        return false;
+    }
+
+    Trajectory::RecordHeader header{};
+    std::memcpy(&header, m_data + headerOffset, sizeof(header));
+
+    const uint64_t payloadOffset = headerOffset + sizeof(header);
+    if (header.type > static_cast<uint8_t>(Trajectory::RecordType::KEYFRAME) or
+        header.payloadSize > m_size - payloadOffset)
+    {
+        return false;
+    }
+
+    out.iteration   = header.iteration;
+    out.type        = static_cast<Trajectory::RecordType>(header.type);
+    out.countA      = header.countA;
+    out.countB      = header.countB;
+    out.countN      = header.countN;
+    out.offset      = payloadOffset;
+    out.payloadSize = header.payloadSize;
+    out.rawSize     = header.rawSize;
+    return true;
+}
+
+bool TrajectoryReader::applyRecord(std::size_t index)
+{
+    const Record&    record  = m_records[index];
+    const QByteArray payload = QByteArray::fromRawData(
+        reinterpret_cast<const char*>(m_data + record.offset),
+        static_cast<qsizetype>(record.payloadSize));
+    const QByteArray raw = qUncompress(payload);
+    if (static_cast<uint64_t>(raw.size()) not_eq record.rawSize)
+    {
+        return false;
+    }
+
+    return (record.type == Trajectory::RecordType::KEYFRAME)
+               ? Trajectory::decodeKeyframe(raw, m_sides)
+               : Trajectory::applyDelta(raw, m_sides);
+}
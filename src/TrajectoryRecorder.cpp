@@ -0,0 +1,220 @@
+#include "TrajectoryRecorder.hpp"
+
+#include "Constants.hpp"
+#include "Simulation.hpp"
+
+#include <QDebug>
+#include <cstring>
+
+namespace
+{
+    bool writeAll(QFile& file, const void* data, std::size_t size)
+    {
+        const auto bytes = static_cast<qint64>(size);
+        return file.write(static_cast<const char*>(data), bytes) == bytes;
+    }
+} // namespace
+
+TrajectoryRecorder::~TrajectoryRecorder()
+{
+    stop();
+}
+
+bool TrajectoryRecorder::start(const QString& path, Simulation& simulation, QString* errorMessage)
+{
+    stop();
+
+    m_file.setFileName(path);
+    if (not m_file.open(QIODevice::WriteOnly bitor QIODevice::Truncate))
+    {
+        if (errorMessage)
+        {
+            *errorMessage = m_file.errorString();
+        }
+        return false;
+    }
+
+    Trajectory::FileHeader header{};
+    std::memcpy(header.magic, Trajectory::kMagic, sizeof(header.magic));
+    header.version          = Trajectory::kVersion;
+    header.byteOrderMark    = Trajectory::kByteOrderMark;
+    header.cols             = simulation.getCols();
+    header.rows             = simulation.getRows();
+    header.keyframeInterval = static_cast<uint32_t>(Config::Trajectory::keyframeInterval);
+
+    if (not writeAll(m_file, &header, sizeof(header)))
+    {
+        if (errorMessage)
+        {
+            *errorMessage = m_file.errorString();
+        }
+        m_file.close();
+        return false;
+    }
+
+    m_index.clear();
+    m_pending.clear();
+    m_stopRequested = false;
+    m_failed        = false;
+    m_running       = true;
+    m_simulation    = &simulation;
+    m_simulation->setChangeCapture(true);
+    m_thread = std::thread([this] { run(); });
+
+    requestKeyframe();
+    record(simulation);
+    return true;
+}
+
+void TrajectoryRecorder::stop()
+{
+    if (not m_running)
+    {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopRequested = true;
+    }
+    m_wake.notify_one();
+    m_thread.join();
+    m_file.close();
+
+    m_simulation->setChangeCapture(false);
+    m_simulation = nullptr;
+    m_running    = false;
+}
+
+void TrajectoryRecorder::record(const Simulation& simulation)
+{
+    if (not m_running)
+    {
+        return;
+    }
+
+    const StepStats& stats = simulation.getlastStepStats();
+
+    Job job;
+    job.iteration = simulation.getIteration();
+    job.countA    = stats.countA;
+    job.countB    = stats.countB;
+    job.countN    = stats.countN;
+
+    if (m_keyframeRequested or m_stepsSinceKeyframe >= Config::Trajectory::keyframeInterval)
+    {
+        job.type = Trajectory::RecordType::KEYFRAME;
+        simulation.copySides(job.sides);
+        m_keyframeRequested  = false;
+        m_stepsSinceKeyframe = 0;
+    }
+    else
+    {
+        job.changes = simulation.getChangedCells();
+    }
+    ++m_stepsSinceKeyframe;
+
+    enqueue(std::move(job));
+}
+
+void TrajectoryRecorder::requestKeyframe()
+{
+    m_keyframeRequested = true;
+}
+
+bool TrajectoryRecorder::isRunning() const
+{
+    return m_running;
+}
+
+bool TrajectoryRecorder::hasFailed() const
+{
+    return m_failed;
+}
+
+void TrajectoryRecorder::enqueue(Job job)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_pending.push_back(std::move(job));
+    }
+    m_wake.notify_one();
+}
+
+void TrajectoryRecorder::run()
+{
+    std::deque<Job> batch;
+    for (;;)
+    {
+        bool stopping = false;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [this] { return m_stopRequested or not m_pending.empty(); });
+            batch.swap(m_pending);
+            stopping = m_stopRequested;
+        }
+
+        for (const auto& job : batch)
+        {
+            if (not m_failed)
+            {
+                writeRecord(job);
+            }
+        }
+        batch.clear();
+
+        if (stopping)
+        {
+            if (not m_failed)
+            {
+                writeIndex();
+            }
+            return;
+        }
+    }
+}
+
+void TrajectoryRecorder::writeRecord(const Job& job)
+{
+    const bool       keyframe = job.type == Trajectory::RecordType::KEYFRAME;
+    const QByteArray raw      = keyframe ? Trajectory::encodeKeyframe(job.sides)
+                                         : Trajectory::encodeDelta(job.changes);
+    const QByteArray payload  = qCompress(raw, Config::Trajectory::compressionLevel);
+
+    Trajectory::RecordHeader header{};
+    header.type        = static_cast<uint8_t>(job.type);
+    header.iteration   = job.iteration;
+    header.countA      = job.countA;
+    header.countB      = job.countB;
+    header.countN      = job.countN;
+    header.rawSize     = static_cast<uint32_t>(raw.size());
+    header.payloadSize = static_cast<uint32_t>(payload.size());
+
+    const qint64 offset = m_file.pos();
+    if (not writeAll(m_file, &header, sizeof(header)) or
+        not writeAll(m_file, payload.constData(), static_cast<std::size_t>(payload.size())))
+    {
+        qWarning() << "TrajectoryRecorder: write failed:" << m_file.errorString();
+        m_failed = true;
+        return;
+    }
+
+    m_index.push_back({job.iteration, header.type, {}, static_cast<uint64_t>(offset)});
+}
+
+void TrajectoryRecorder::writeIndex()
+{
+    Trajectory::IndexFooter footer{};
+    footer.count       = m_index.size();
+    footer.indexOffset = static_cast<uint64_t>(m_file.pos());
+    std::memcpy(footer.magic, Trajectory::kIndexMagic, sizeof(footer.magic));
+
+    const bool ok =
+        writeAll(m_file, m_index.data(), m_index.size() * sizeof(Trajectory::IndexEntry)) and
+        writeAll(m_file, &footer, sizeof(footer)) and m_file.flush();
+    if (not ok)
+    {
+        qWarning() << "TrajectoryRecorder: writing index failed:" << m_file.errorString();
+        m_failed = true;
+    }
+}
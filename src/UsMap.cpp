@@ -1,15 +1,25 @@
 #include "UsMap.hpp"
 
+#include "Constants.hpp"
+#include "Parallel.hpp"
+
 #include <QCoreApplication>
 #include <QDebug>
 #include <QDir>
 #include <QFile>
+#include <QPaintDevice>
 #include <QPainter>
 #include <QRegularExpression>
 #include <QXmlStreamReader>
+#include <QXmlStreamWriter>
 #include <QtMath>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
 #include <cstddef>
 #include <cstdint>
+#include <memory>
 #include <qbytearrayview.h>
 #include <qdebug.h>
 #include <qglobal.h>
@@ -18,14 +28,10 @@
 #include <qstringview.h>
 #include <span>
 
-UsMap::UsMap(QString svgFilePath, int cols, int rows)
-    : m_svgFilePath(std::move(svgFilePath)), m_outputProducts({{}, {}, cols, rows})
+UsMap::UsMap(QString svgFilePath, int cols, int rows) : m_svgFilePath(std::move(svgFilePath))
 {
-    m_outputProducts.activeStates.resize(
-        static_cast<std::size_t>(cols) * static_cast<std::size_t>(rows), 0);
-    m_outputProducts.stateIds.resize(
-        static_cast<std::size_t>(cols) * static_cast<std::size_t>(rows), kNoState);
-    m_statePixelCount.clear();
+    m_outlineTiles.setMaxCost(Config::Map::outlineCacheMaxPixels);
+    setGridSize(cols, rows);
 
     if (m_debugEnabled and m_debugDir.isEmpty())
     {
@@ -33,6 +39,16 @@ UsMap::UsMap(QString svgFilePath, int cols, int rows)
     }
 }
 
+void UsMap::setGridSize(int cols, int rows)
+{
+    const std::size_t count = static_cast<std::size_t>(cols) * static_cast<std::size_t>(rows);
+
+    m_outputProducts = {std::vector<uint8_t>(count, 0), std::vector<uint8_t>(count, kNoState),
+                        cols, rows};
+    m_statePixelCount.clear();
+    m_productsBuilt = false;
+}
+
 bool UsMap::loadAndParseSvg(QString* errorMessage)
 {
     if (not loadSvgPatched(errorMessage))
@@ -41,7 +57,7 @@ bool UsMap::loadAndParseSvg(QString* errorMessage)
         return false;
     }
 
-    if (not scanStatesFromSvg())
+    if (m_states.empty())
     {
         qWarning() << "[UsMap] No states parsed from SVG.";
     }
@@ -58,66 +74,252 @@ bool UsMap::loadAndParseSvg(QString* errorMessage)
 
 void UsMap::drawStateOutlines(QPainter& painter, const QRect& rect) const
 {
+    if (not m_svgOutlineRenderer.isValid() or rect.isEmpty())
+    {
+        return;
+    }
+
+    const qreal  dpr = painter.device() ? painter.device()->devicePixelRatioF() : 1.0;
+    const qint64 devicePixels = static_cast<qint64>(std::ceil(rect.width() * dpr)) *
+                                static_cast<qint64>(std::ceil(rect.height() * dpr));
+
+    // Rozmiar zależy tylko od zoomu; przesunięcie mapy nie unieważnia ani pixmapy, ani kafli
+    if (m_outlineCacheSize not_eq rect.size() or not qFuzzyCompare(m_outlineCacheDpr, dpr))
+    {
+        invalidateOutlineCache();
+    }
+
     painter.save();
-    painter.setRenderHint(QPainter::Antialiasing, true);
-    painter.setRenderHint(QPainter::SmoothPixmapTransform, true);
 
-    if (not m_svgOutlineRenderer.isValid())
+    if (devicePixels > Config::Map::outlineCacheMaxPixels)
     {
+        // Przy dużym zoomie pixmapa całej mapy byłaby za duża - kafle widocznego fragmentu
+        m_outlineCache     = QPixmap();
+        m_outlineCacheSize = rect.size();
+        m_outlineCacheDpr  = dpr;
+        drawOutlineTiles(painter, rect, dpr);
         painter.restore();
         return;
     }
 
-    m_svgOutlineRenderer.render(&painter, rect);
+    if (m_outlineCache.isNull())
+    {
+        rebuildOutlineCache(rect.size(), dpr);
+    }
 
+    painter.drawPixmap(rect.topLeft(), m_outlineCache);
     painter.restore();
 }
 
-void UsMap::buildMaskAndActiveStates(int cols, int rows)
+void UsMap::invalidateOutlineCache() const
+{
+    m_outlineCache = QPixmap();
+    m_outlineTiles.clear();
+    m_outlineCacheSize = QSize();
+    m_outlineCacheDpr  = 0.0;
+}
+
+void UsMap::drawOutlineTiles(QPainter& painter, const QRect& rect, qreal dpr) const
 {
-    m_maskImage = QImage(cols, rows, QImage::Format_Grayscale8);
-    m_maskImage.fill(Qt::black);
+    // Widoczna część mapy: obszar urządzenia (w układzie painter'a) zawężony do clipa
+    QRect visible = rect;
+    if (painter.device())
     {
-        QPainter painter(&m_maskImage);
-        painter.setRenderHint(QPainter::Antialiasing, false);
-        painter.setCompositionMode(QPainter::CompositionMode_Source);
-        m_svgRenderer.render(&painter, QRectF(0, 0, cols, rows));
+        const QRect device(0, 0, painter.device()->width(), painter.device()->height());
+        visible &= painter.worldTransform().inverted().mapRect(device);
     }
-    for (int y = 0; y < rows; ++y)
+    if (painter.hasClipping())
     {
-        const uchar*           linePtr = m_maskImage.constScanLine(y);
-        std::span<const uchar> line{linePtr, static_cast<std::size_t>(cols)};
-        for (int x = 0; x < cols; ++x)
-        {
-            m_outputProducts.activeStates[static_cast<std::size_t>(y * cols + x)] =
-                (line[static_cast<std::size_t>(x)] > 0) ? 1 : 0;
-        }
+        visible &= painter.clipBoundingRect().toAlignedRect();
     }
-    if (m_debugEnabled)
+    if (visible.isEmpty())
     {
-        debugSave(QStringLiteral("01_mask.png"), m_maskImage);
+        return;
     }
-}
 
-QImage UsMap::renderColorImage(int cols, int rows) const
-{
-    QImage colorImage(cols, rows, QImage::Format_ARGB32_Premultiplied);
-    colorImage.fill(Qt::transparent);
+    // Kafle w układzie mapy (względem rect.topLeft()), więc pan tylko je przerysowuje
+    const int   tile  = Config::Map::outlineTileSize;
+    const QRect local = visible.translated(-rect.topLeft());
+    for (int ty = local.top() / tile; ty <= local.bottom() / tile; ++ty)
     {
-        QPainter painter(&colorImage);
-        painter.setRenderHint(QPainter::Antialiasing, false);
-        painter.setCompositionMode(QPainter::CompositionMode_Source);
-        m_svgRenderer.render(&painter, QRectF(0, 0, cols, rows));
+        for (int tx = local.left() / tile; tx <= local.right() / tile; ++tx)
+        {
+            const quint64 key = (static_cast<quint64>(static_cast<uint32_t>(tx)) << 32) bitor
+                                static_cast<uint32_t>(ty);
+            const QRect tileRect(tx * tile, ty * tile, tile, tile);
+
+            QPixmap pixmap;
+            if (const QPixmap* cached = m_outlineTiles.object(key))
+            {
+                pixmap = *cached;
+            }
+            else
+            {
+                pixmap = renderOutlineTile(tileRect, rect.size(), dpr);
+                m_outlineTiles.insert(key, new QPixmap(pixmap),
+                                      static_cast<qsizetype>(pixmap.width()) * pixmap.height());
+            }
+            painter.drawPixmap(rect.topLeft() + tileRect.topLeft(), pixmap);
+        }
     }
+}
 
-    if (m_debugEnabled)
+QPixmap UsMap::renderOutlineTile(const QRect& tile, const QSize& mapSize, qreal dpr) const
+{
+    QPixmap pixmap(QSize(static_cast<int>(std::ceil(tile.width() * dpr)),
+                         static_cast<int>(std::ceil(tile.height() * dpr))));
+    pixmap.setDevicePixelRatio(dpr);
+    pixmap.fill(Qt::transparent);
+
+    QPainter painter(&pixmap);
+    painter.setRenderHint(QPainter::Antialiasing, true);
+    painter.setRenderHint(QPainter::SmoothPixmapTransform, true);
+    painter.translate(-tile.topLeft());
+    painter.setClipRect(tile);
+    m_svgOutlineRenderer.render(&painter, QRectF(QPointF(0, 0), QSizeF(mapSize)));
+    return pixmap;
+}
+
+void UsMap::rebuildOutlineCache(const QSize& size, qreal dpr) const
+{
+    m_outlineCache = QPixmap(QSize(static_cast<int>(std::ceil(size.width() * dpr)),
+                                   static_cast<int>(std::ceil(size.height() * dpr))));
+    m_outlineCache.setDevicePixelRatio(dpr);
+    m_outlineCache.fill(Qt::transparent);
     {
-        debugSave(QStringLiteral("02_color_full.png"), colorImage);
+        QPainter painter(&m_outlineCache);
+        painter.setRenderHint(QPainter::Antialiasing, true);
+        painter.setRenderHint(QPainter::SmoothPixmapTransform, true);
+        m_svgOutlineRenderer.render(&painter, QRectF(QPointF(0, 0), QSizeF(size)));
     }
 
-    return colorImage;
+    m_outlineCacheSize = size;
+    m_outlineCacheDpr  = dpr;
 }
 
+namespace
+{
+    // Wyszukiwanie koloru w posortowanej palecie z małym cache bezpośrednio mapowanym przed
+    // nim - sąsiednie piksele mają zwykle ten sam kolor, więc binarne wyszukiwanie jest rzadkie.
+    // Jedna instancja na wątek.
+    template <typename Entry> class PaletteLookup
+    {
+        public:
+            explicit PaletteLookup(const std::vector<Entry>& palette) : m_palette(palette) {}
+
+            [[nodiscard]] uint8_t find(QRgb color)
+            {
+                Slot& slot = m_cache[(color * 0x9E3779B1u) >> (32 - kCacheBits)];
+                if (slot.valid and slot.color == color)
+                {
+                    return slot.state;
+                }
+
+                auto it = std::lower_bound(m_palette.begin(), m_palette.end(), color,
+                                           [](const Entry& e, QRgb c) { return e.color < c; });
+                const bool    found = it not_eq m_palette.end() and it->color == color;
+                const uint8_t state = found ? it->state : UsMap::kNoState;
+
+                slot = {color, state, true};
+                return state;
+            }
+
+        private:
+            static constexpr unsigned kCacheBits = 6;
+
+            struct Slot
+            {
+                    QRgb    color = 0;
+                    uint8_t state = UsMap::kNoState;
+                    bool    valid = false;
+            };
+
+            const std::vector<Entry>&         m_palette;
+            std::array<Slot, 1 << kCacheBits> m_cache{};
+    };
+
+    template <typename Entry> PaletteLookup(const std::vector<Entry>&) -> PaletteLookup<Entry>;
+
+    struct TileTarget
+    {
+            int      x0{};
+            int      y0{};
+            int      width{};
+            int      height{};
+            int      cols{};
+            uint8_t* activeStates{};
+            uint8_t* stateIds{};
+            int*     histogram{};
+    };
+
+    // Głosowanie w bloku samples x samples subpikseli na komórkę: komórka jest aktywna, gdy
+    // większość subpikseli jest pokryta, a stan to najczęstszy rozpoznany kolor
+    template <typename Lookup>
+    void voteTile(const QImage& image, int samples, Lookup& lookup, const TileTarget& target)
+    {
+        const int                                    sampleCount = samples * samples;
+        std::array<uint8_t, Config::Map::maxSamples> found{};
+
+        for (int y = 0; y < target.height; ++y)
+        {
+            const std::size_t rowStart = static_cast<std::size_t>(target.y0 + y) *
+                                             static_cast<std::size_t>(target.cols) +
+                                         static_cast<std::size_t>(target.x0);
+            for (int x = 0; x < target.width; ++x)
+            {
+                int covered = 0;
+                int known   = 0;
+                for (int sy = 0; sy < samples; ++sy)
+                {
+                    const QRgb* line =
+                        reinterpret_cast<const QRgb*>(image.constScanLine(y * samples + sy));
+                    for (int sx = 0; sx < samples; ++sx)
+                    {
+                        const QRgb pixel = line[x * samples + sx];
+                        if (qAlpha(pixel) == 0)
+                        {
+                            continue;
+                        }
+                        ++covered;
+
+                        const uint8_t sid = lookup.find(pixel);
+                        if (sid not_eq UsMap::kNoState)
+                        {
+                            found[static_cast<std::size_t>(known++)] = sid;
+                        }
+                    }
+                }
+
+                // Najwyżej maxSamples głosów, więc wystarczy proste zliczanie
+                uint8_t best      = UsMap::kNoState;
+                int     bestVotes = 0;
+                for (auto it = found.begin(); it not_eq found.begin() + known; ++it)
+                {
+                    const auto votes = static_cast<int>(std::count(it, found.begin() + known, *it));
+                    if (votes > bestVotes)
+                    {
+                        best      = *it;
+                        bestVotes = votes;
+                    }
+                    if (bestVotes * 2 > known)
+                    {
+                        break;
+                    }
+                }
+
+                const std::size_t index    = rowStart + static_cast<std::size_t>(x);
+                const bool        active   = covered * 2 > sampleCount;
+                target.activeStates[index] = active ? 1 : 0;
+                target.stateIds[index]     = active ? best : UsMap::kNoState;
+                if (active and best not_eq UsMap::kNoState)
+                {
+                    target.histogram[best] += 1;
+                }
+            }
+        }
+    }
+} // namespace
+
 QString UsMap::rgbToHex(QRgb c) const
 {
     const int rgb = (qRed(c) << 16) bitor (qGreen(c) << 8) bitor qBlue(c);
@@ -126,7 +328,7 @@ QString UsMap::rgbToHex(QRgb c) const
 
 void UsMap::buildColorToStateMap()
 {
-    m_colorToState.clear();
+    m_palette.clear();
 
     for (int stateId = 0; stateId < static_cast<int>(m_states.size()); ++stateId)
     {
@@ -140,57 +342,147 @@ void UsMap::buildColorToStateMap()
             continue;
         }
 
-        m_colorToState.insert(svgColor, static_cast<uint8_t>(stateId));
+        m_palette.push_back({svgColor, static_cast<uint8_t>(stateId)});
 
         if (m_debugEnabled)
         {
             qDebug() << "[UsMap] State:" << state.id << "| Fill color:" << rgbToHex(svgColor);
         }
     }
-}
 
-void UsMap::initProductsBuffers()
-{
-    m_statePixelCount.assign(m_states.size(), 0);
-    std::fill(m_outputProducts.stateIds.begin(), m_outputProducts.stateIds.end(), kNoState);
+    // Przy powtórzonym kolorze wygrywa późniejszy stan (tak jak przy wstawianiu do mapy)
+    std::stable_sort(m_palette.begin(), m_palette.end(), [](const auto& a, const auto& b)
+                     { return a.color < b.color; });
+    std::vector<PaletteEntry> unique;
+    unique.reserve(m_palette.size());
+    for (const auto& entry : m_palette)
+    {
+        if (not unique.empty() and unique.back().color == entry.color)
+        {
+            unique.back() = entry;
+            continue;
+        }
+        unique.push_back(entry);
+    }
+    m_palette = std::move(unique);
 }
 
-void UsMap::assignStatesFromColorImage(const QImage& colorImage, int cols, int rows)
+void UsMap::rasterizeProducts(int cols, int rows)
 {
-    initProductsBuffers();
+    const int  tileCells = Config::Map::rasterTileCells;
+    const int  samples   = Config::Map::rasterSupersample;
+    const int  tilesX    = (cols + tileCells - 1) / tileCells;
+    const int  tilesY    = (rows + tileCells - 1) / tileCells;
+    const auto tileCount = static_cast<std::size_t>(tilesX) * static_cast<std::size_t>(tilesY);
 
-    for (int y = 0; y < rows; ++y)
-    {
-        const QRgb*           linePtr = reinterpret_cast<const QRgb*>(colorImage.constScanLine(y));
-        std::span<const QRgb> line{linePtr, static_cast<std::size_t>(cols)};
+    // Pamięć ograniczona do jednego obrazu kafla na wątek, niezależnie od rozmiaru siatki
+    const unsigned workers = Parallel::workerCount(tileCount, 1);
+    std::vector<std::vector<int>> histograms(workers, std::vector<int>(m_states.size(), 0));
+    std::atomic<std::size_t>      nextTile{0};
 
-        for (int x = 0; x < cols; ++x)
+    Parallel::forRanges(
+        workers, workers,
+        [&](unsigned worker, std::size_t, std::size_t)
         {
-            const int i = y * cols + x;
-            if (not m_outputProducts.activeStates[static_cast<std::size_t>(i)])
+            // QSvgRenderer nie jest bezpieczny wątkowo - pozostałe wątki ładują własną kopię
+            std::unique_ptr<QSvgRenderer> ownRenderer;
+            QSvgRenderer*                 renderer = &m_svgRenderer;
+            if (worker > 0)
             {
-                continue;
-            }
-            if (qAlpha(line[static_cast<std::size_t>(x)]) == 0)
-            {
-                continue;
+                ownRenderer = std::make_unique<QSvgRenderer>(m_svgRaw);
+                renderer    = ownRenderer.get();
             }
 
-            auto it = m_colorToState.constFind(line[static_cast<std::size_t>(x)]);
-            if (it == m_colorToState.constEnd())
+            QImage        image(tileCells * samples, tileCells * samples,
+                                QImage::Format_ARGB32_Premultiplied);
+            PaletteLookup lookup(m_palette);
+
+            // Kafle pobierane dynamicznie - te nad oceanem są dużo tańsze od lądowych
+            for (std::size_t tile = nextTile++; tile < tileCount; tile = nextTile++)
             {
-                continue;
+                const auto tileX = static_cast<int>(tile % static_cast<std::size_t>(tilesX));
+                const auto tileY = static_cast<int>(tile / static_cast<std::size_t>(tilesX));
+
+                TileTarget target;
+                target.x0           = tileX * tileCells;
+                target.y0           = tileY * tileCells;
+                target.width        = std::min(tileCells, cols - target.x0);
+                target.height       = std::min(tileCells, rows - target.y0);
+                target.cols         = cols;
+                target.activeStates = m_outputProducts.activeStates.data();
+                target.stateIds     = m_outputProducts.stateIds.data();
+                target.histogram    = histograms[worker].data();
+
+                image.fill(Qt::transparent);
+                {
+                    QPainter painter(&image);
+                    painter.setRenderHint(QPainter::Antialiasing, false);
+                    painter.setCompositionMode(QPainter::CompositionMode_Source);
+                    renderer->render(&painter, QRectF(-target.x0 * samples, -target.y0 * samples,
+                                                      cols * samples, rows * samples));
+                }
+                voteTile(image, samples, lookup, target);
             }
-            const uint8_t     sid            = it.value();
-            const std::size_t index          = static_cast<std::size_t>(i);
-            m_outputProducts.stateIds[index] = sid;
-            m_statePixelCount[sid] += 1;
+        });
+
+    m_statePixelCount.assign(m_states.size(), 0);
+    for (const auto& histogram : histograms)
+    {
+        for (std::size_t sid = 0; sid < histogram.size(); ++sid)
+        {
+            m_statePixelCount[sid] += histogram[sid];
         }
     }
+
+    if (m_debugEnabled)
+    {
+        debugSaveProducts(cols, rows);
+    }
+}
+
+void UsMap::debugSaveProducts(int cols, int rows) const
+{
+    QImage mask(cols, rows, QImage::Format_Grayscale8);
+    QImage states(cols, rows, QImage::Format_ARGB32);
+    for (int y = 0; y < rows; ++y)
+    {
+        uchar* maskLine  = mask.scanLine(y);
+        QRgb*  stateLine = reinterpret_cast<QRgb*>(states.scanLine(y));
+        for (int x = 0; x < cols; ++x)
+        {
+            const auto index =
+                static_cast<std::size_t>(y) * static_cast<std::size_t>(cols) +
+                static_cast<std::size_t>(x);
+            const uint8_t sid = m_outputProducts.stateIds[index];
+
+            maskLine[x]  = m_outputProducts.activeStates[index] ? 255 : 0;
+            stateLine[x] = isValidStateId(sid) ? m_states[sid].fill : qRgba(0, 0, 0, 0);
+        }
+    }
+
+    debugSave(QStringLiteral("01_mask.png"), mask);
+    debugSave(QStringLiteral("02_states.png"), states);
 }
 
 bool UsMap::buildStateProducts(QString* errorMessage)
 {
+    if (not readSvgFile(errorMessage))
+    {
+        return false;
+    }
+    hashSvg();
+
+    // Tryb debug zapisuje obrazy pośrednie, więc wtedy zawsze rasteryzujemy od nowa
+    if (not m_debugEnabled and loadProductsCache())
+    {
+        if (not loadSvgOutlineWithoutFill(errorMessage))
+        {
+            return false;
+        }
+        m_productsBuilt = true;
+        return true;
+    }
+
     if (not loadAndParseSvg(errorMessage))
     {
         return false;
@@ -199,10 +491,9 @@ bool UsMap::buildStateProducts(QString* errorMessage)
     const int cols = m_outputProducts.cols;
     const int rows = m_outputProducts.rows;
 
-    buildMaskAndActiveStates(cols, rows);
-    const QImage colorImage = renderColorImage(cols, rows);
     buildColorToStateMap();
-    assignStatesFromColorImage(colorImage, cols, rows);
+    rasterizeProducts(cols, rows);
+    saveProductsCache();
 
     m_productsBuilt = true;
     return true;
@@ -227,20 +518,82 @@ bool UsMap::readSvgFile(QString* errorMessage)
     }
 
     m_svgRawOriginal = mapFile.readAll();
-    m_svgRaw         = m_svgRawOriginal;
+    m_svgRaw.clear();
+    m_svgOutlineRaw.clear();
     return true;
 }
 
-static QByteArray removeStatesFills(const QByteArray& original)
+namespace
 {
-    QString xml = QString::fromUtf8(original);
+    // "stroke-width:0.97;fill:#a1b2c3" -> "stroke-width:0.97;fill:none" dla property == "fill"
+    QString disableStyleProperty(QStringView style, QLatin1StringView property)
+    {
+        QString patched;
+        patched.reserve(style.size());
 
-    QRegularExpression regex(R"(fill\s*:[^;"]*)");
+        bool first = true;
+        for (const QStringView part : style.split(u';'))
+        {
+            if (not first)
+            {
+                patched += u';';
+            }
+            first = false;
 
-    xml.replace(regex, "fill:none");
+            const auto position = part.indexOf(u':');
+            if (position > 0 and part.left(position).trimmed() == property)
+            {
+                patched += property;
+                patched += QLatin1StringView(":none");
+            }
+            else
+            {
+                patched += part;
+            }
+        }
+        return patched;
+    }
 
-    return xml.toUtf8();
-}
+    // Wyłącza property zarówno w atrybucie style, jak i jako atrybut prezentacji
+    QXmlStreamAttributes disableProperty(const QXmlStreamAttributes& attributes,
+                                         QLatin1StringView           property)
+    {
+        QXmlStreamAttributes patched;
+        patched.reserve(attributes.size());
+
+        for (const auto& attribute : attributes)
+        {
+            QString value = attribute.value().toString();
+            if (attribute.namespaceUri().isEmpty())
+            {
+                if (attribute.name() == QLatin1StringView("style"))
+                {
+                    value = disableStyleProperty(attribute.value(), property);
+                }
+                else if (attribute.name() == property)
+                {
+                    value = QStringLiteral("none");
+                }
+            }
+            patched.append(attribute.namespaceUri().toString(), attribute.name().toString(),
+                           value);
+        }
+        return patched;
+    }
+
+    // Jak QXmlStreamWriter::writeCurrentToken, ale z podmienionymi atrybutami
+    void writeStartElement(QXmlStreamWriter& writer, const QXmlStreamReader& xml,
+                           const QXmlStreamAttributes& attributes)
+    {
+        writer.writeStartElement(xml.namespaceUri().toString(), xml.name().toString());
+        for (const auto& declaration : xml.namespaceDeclarations())
+        {
+            writer.writeNamespace(declaration.namespaceUri().toString(),
+                                  declaration.prefix().toString());
+        }
+        writer.writeAttributes(attributes);
+    }
+} // namespace
 
 bool UsMap::loadSvgOutlineWithoutFill(QString* errorMessage)
 {
@@ -252,23 +605,23 @@ bool UsMap::loadSvgOutlineWithoutFill(QString* errorMessage)
         }
     }
 
-    const QByteArray statesWithoutFill = removeStatesFills(m_svgRawOriginal);
+    // Po trafieniu w cache produktów stany są już wczytane: wystarczą same kontury
+    if (m_svgOutlineRaw.isEmpty() and not rewriteSvgOutline(errorMessage))
+    {
+        return false;
+    }
 
-    if (not m_svgOutlineRenderer.load(statesWithoutFill))
+    if (not m_svgOutlineRenderer.load(m_svgOutlineRaw))
     {
         setError(errorMessage,
                  "[UsMap] QSvgRenderer: failed to load outlines for " + m_svgFilePath);
         return false;
     }
 
+    invalidateOutlineCache();
     return true;
 }
 
-void UsMap::removeStatesOutlines()
-{
-    m_svgRaw.replace("stroke:#000", "stroke:none");
-}
-
 bool UsMap::loadSvgIntoRenderer(QString* errorMessage)
 {
     if (not m_svgRenderer.load(m_svgRaw))
@@ -282,12 +635,18 @@ bool UsMap::loadSvgIntoRenderer(QString* errorMessage)
 
 bool UsMap::loadSvgPatched(QString* errorMessage)
 {
-    if (not readSvgFile(errorMessage))
+    if (m_svgRawOriginal.isEmpty())
     {
-        return false;
+        if (not readSvgFile(errorMessage))
+        {
+            return false;
+        }
     }
 
-    removeStatesOutlines();
+    if (not rewriteSvg(errorMessage))
+    {
+        return false;
+    }
 
     if (not loadSvgIntoRenderer(errorMessage))
     {
@@ -403,32 +762,92 @@ void UsMap::reportXmlError(const QXmlStreamReader& xml) const
         qWarning() << "[UsMap] XML parse error:" << xml.errorString();
 }
 
-bool UsMap::scanStatesFromSvg()
+bool UsMap::rewriteSvg(QString* errorMessage)
 {
+    // Jedno przejście strumieniowe: tabela stanów + wariant do rasteryzacji stanów
+    // (bez konturów) + wariant z samymi konturami (bez wypełnień)
     resetStates();
+    m_svgRaw.clear();
+    m_svgOutlineRaw.clear();
 
-    QXmlStreamReader xml(m_svgRaw);
+    QXmlStreamReader xml(m_svgRawOriginal);
+    QXmlStreamWriter fillWriter(&m_svgRaw);
+    QXmlStreamWriter outlineWriter(&m_svgOutlineRaw);
 
     while (not xml.atEnd())
     {
         xml.readNext();
+        if (xml.hasError())
+        {
+            break;
+        }
 
         if (not xml.isStartElement())
         {
+            fillWriter.writeCurrentToken(xml);
+            outlineWriter.writeCurrentToken(xml);
             continue;
         }
 
-        const QString tagName = xml.name().toString();
-        if (not isStateElement(tagName))
+        const QXmlStreamAttributes attributes = xml.attributes();
+        if (isStateElement(xml.name().toString()))
         {
+            processStateElement(attributes);
+        }
+
+        writeStartElement(fillWriter, xml,
+                          disableProperty(attributes, QLatin1StringView("stroke")));
+        writeStartElement(outlineWriter, xml,
+                          disableProperty(attributes, QLatin1StringView("fill")));
+    }
+
+    if (xml.hasError())
+    {
+        reportXmlError(xml);
+        setError(errorMessage, "[UsMap] XML parse error in " + m_svgFilePath + ": " +
+                                   xml.errorString());
+        m_svgRaw.clear();
+        m_svgOutlineRaw.clear();
+        return false;
+    }
+    return true;
+}
+
+bool UsMap::rewriteSvgOutline(QString* errorMessage)
+{
+    // Przejście strumieniowe tylko dla wariantu konturów; nie rusza tabeli stanów
+    m_svgOutlineRaw.clear();
+
+    QXmlStreamReader xml(m_svgRawOriginal);
+    QXmlStreamWriter outlineWriter(&m_svgOutlineRaw);
+
+    while (not xml.atEnd())
+    {
+        xml.readNext();
+        if (xml.hasError())
+        {
+            break;
+        }
+
+        if (not xml.isStartElement())
+        {
+            outlineWriter.writeCurrentToken(xml);
             continue;
         }
 
-        processStateElement(xml.attributes());
+        writeStartElement(outlineWriter, xml,
+                          disableProperty(xml.attributes(), QLatin1StringView("fill")));
     }
 
-    reportXmlError(xml);
-    return not m_states.empty();
+    if (xml.hasError())
+    {
+        reportXmlError(xml);
+        setError(errorMessage, "[UsMap] XML parse error in " + m_svgFilePath + ": " +
+                                   xml.errorString());
+        m_svgOutlineRaw.clear();
+        return false;
+    }
+    return true;
 }
 
 const UsMap::Products& UsMap::getProducts() const
@@ -0,0 +1,238 @@
+#include "UsMap.hpp"
+
+#include "Constants.hpp"
+
+#include <QCryptographicHash>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <cstring>
+
+// Cache produktów rasteryzacji mapy (wersja 3, kolejność bajtów hosta zapisana w nagłówku):
+//   Header, StateEntry[stateCount], napisy UTF-8 (wyrównane do 8 bajtów),
+//   activeStates[cols*rows], stateIds[cols*rows].
+// Kluczem jest SHA-1 treści SVG i rozmiar siatki; zmiana pliku albo rozdzielczości daje
+// po prostu inny plik. Przy zmianie sposobu rasteryzacji trzeba podbić kVersion.
+namespace
+{
+    constexpr char        kMagic[8]      = {'P', 'S', 'M', 'A', 'P', '\0', '\0', '\0'};
+    constexpr uint32_t    kVersion       = 3;
+    constexpr uint32_t    kByteOrderMark = 0x01020304;
+    constexpr std::size_t kAlignment     = 8;
+    constexpr std::size_t kHashSize      = 20; // SHA-1
+
+    struct Header
+    {
+            char     magic[8];
+            uint32_t version;
+            uint32_t byteOrderMark;
+            int32_t  cols;
+            int32_t  rows;
+            uint8_t  svgHash[kHashSize];
+            uint32_t stateCount;
+            uint32_t stringBytes;
+            uint32_t reserved;
+    };
+
+    struct StateEntry
+    {
+            uint32_t fill;
+            uint32_t idOffset;
+            uint32_t idSize;
+            uint32_t nameOffset;
+            uint32_t nameSize;
+            int32_t  pixelCount;
+    };
+
+    static_assert(sizeof(Header) == 56);
+    static_assert(sizeof(StateEntry) == 24);
+
+    std::size_t alignUp(std::size_t value)
+    {
+        return (value + kAlignment - 1) / kAlignment * kAlignment;
+    }
+} // namespace
+
+QString UsMap::productsCachePath() const
+{
+    const QString dir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    if (dir.isEmpty() or m_svgHash.isEmpty())
+    {
+        return {};
+    }
+
+    return QStringLiteral("%1/%2/%3_%4x%5.pmap")
+        .arg(dir, Config::Map::productsCacheDir, QString::fromLatin1(m_svgHash.toHex()))
+        .arg(m_outputProducts.cols)
+        .arg(m_outputProducts.rows);
+}
+
+void UsMap::hashSvg()
+{
+    m_svgHash = QCryptographicHash::hash(m_svgRawOriginal, QCryptographicHash::Sha1);
+}
+
+bool UsMap::loadProductsCache()
+{
+    const QString path = productsCachePath();
+    if (path.isEmpty())
+    {
+        return false;
+    }
+
+    QFile file(path);
+    if (not file.open(QIODevice::ReadOnly))
+    {
+        return false;
+    }
+
+    const auto   size = static_cast<std::size_t>(file.size());
+    const uchar* data = file.map(0, file.size());
+    QByteArray   fallback;
+    if (not data)
+    {
+        fallback = file.readAll();
+        data     = reinterpret_cast<const uchar*>(fallback.constData());
+    }
+
+    if (size < sizeof(Header))
+    {
+        return false;
+    }
+    Header header{};
+    std::memcpy(&header, data, sizeof(header));
+
+    const int cols = m_outputProducts.cols;
+    const int rows = m_outputProducts.rows;
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) not_eq 0 or
+        header.version not_eq kVersion or header.byteOrderMark not_eq kByteOrderMark or
+        header.cols not_eq cols or header.rows not_eq rows or
+        static_cast<std::size_t>(m_svgHash.size()) not_eq kHashSize or
+        std::memcmp(header.svgHash, m_svgHash.constData(), kHashSize) not_eq 0 or
+        header.stateCount >= kNoState)
+    {
+        return false;
+    }
+
+    const std::size_t cellCount = static_cast<std::size_t>(cols) * static_cast<std::size_t>(rows);
+
+    const std::size_t tableOffset   = sizeof(Header);
+    const std::size_t stringsOffset = tableOffset + header.stateCount * sizeof(StateEntry);
+    const std::size_t planesOffset  = alignUp(stringsOffset + header.stringBytes);
+    if (size not_eq planesOffset + 2 * cellCount)
+    {
+        return false;
+    }
+
+    const auto readString = [&](uint32_t offset, uint32_t length, QString& out)
+    {
+        if (offset > header.stringBytes or length > header.stringBytes - offset)
+        {
+            return false;
+        }
+        out = QString::fromUtf8(reinterpret_cast<const char*>(data + stringsOffset + offset),
+                                static_cast<qsizetype>(length));
+        return true;
+    };
+
+    std::vector<State> states(header.stateCount);
+    std::vector<int>   pixelCount(header.stateCount);
+    for (uint32_t i = 0; i < header.stateCount; ++i)
+    {
+        StateEntry entry{};
+        std::memcpy(&entry, data + tableOffset + i * sizeof(entry), sizeof(entry));
+        if (not readString(entry.idOffset, entry.idSize, states[i].id) or
+            not readString(entry.nameOffset, entry.nameSize, states[i].name))
+        {
+            return false;
+        }
+        states[i].fill = entry.fill;
+        pixelCount[i]  = entry.pixelCount;
+    }
+
+    const uchar* active   = data + planesOffset;
+    const uchar* stateIds = active + cellCount;
+    for (std::size_t i = 0; i < cellCount; ++i)
+    {
+        if (stateIds[i] not_eq kNoState and stateIds[i] >= header.stateCount)
+        {
+            return false;
+        }
+    }
+
+    // Wszystko sprawdzone - dopiero teraz podmieniamy stan
+    resetStates();
+    for (auto& state : states)
+    {
+        insertOrUpdateState(std::move(state));
+    }
+    m_statePixelCount = std::move(pixelCount);
+    m_outputProducts.activeStates.assign(active, active + cellCount);
+    m_outputProducts.stateIds.assign(stateIds, stateIds + cellCount);
+    return true;
+}
+
+void UsMap::saveProductsCache() const
+{
+    const QString path = productsCachePath();
+    if (path.isEmpty() or not QDir().mkpath(QFileInfo(path).absolutePath()))
+    {
+        return;
+    }
+
+    QByteArray              strings;
+    std::vector<StateEntry> table(m_states.size());
+    for (std::size_t i = 0; i < m_states.size(); ++i)
+    {
+        const QByteArray id   = m_states[i].id.toUtf8();
+        const QByteArray name = m_states[i].name.toUtf8();
+
+        table[i].fill       = m_states[i].fill;
+        table[i].idOffset   = static_cast<uint32_t>(strings.size());
+        table[i].idSize     = static_cast<uint32_t>(id.size());
+        table[i].nameOffset = static_cast<uint32_t>(strings.size() + id.size());
+        table[i].nameSize   = static_cast<uint32_t>(name.size());
+        table[i].pixelCount = (i < m_statePixelCount.size()) ? m_statePixelCount[i] : 0;
+        strings += id;
+        strings += name;
+    }
+
+    Header header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version       = kVersion;
+    header.byteOrderMark = kByteOrderMark;
+    header.cols          = m_outputProducts.cols;
+    header.rows          = m_outputProducts.rows;
+    std::memcpy(header.svgHash, m_svgHash.constData(), kHashSize);
+    header.stateCount  = static_cast<uint32_t>(table.size());
+    header.stringBytes = static_cast<uint32_t>(strings.size());
+
+    const std::size_t stringsEnd = sizeof(Header) + table.size() * sizeof(StateEntry) +
+                                   static_cast<std::size_t>(strings.size());
+    strings.append(static_cast<qsizetype>(alignUp(stringsEnd) - stringsEnd), '\0');
+
+    QSaveFile file(path);
+    if (not file.open(QIODevice::WriteOnly))
+    {
+        qWarning() << "[UsMap] Cannot write products cache" << path;
+        return;
+    }
+
+    const auto& products = m_outputProducts;
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(table.data()),
+               static_cast<qint64>(table.size() * sizeof(StateEntry)));
+    file.write(strings);
+    file.write(reinterpret_cast<const char*>(products.activeStates.data()),
+               static_cast<qint64>(products.activeStates.size()));
+    file.write(reinterpret_cast<const char*>(products.stateIds.data()),
+               static_cast<qint64>(products.stateIds.size()));
+
+    if (not file.commit())
+    {
+        qWarning() << "[UsMap] Writing products cache failed:" << file.errorString();
+    }
+}